@@ -0,0 +1,149 @@
+#include <algine/core/window/Window.h>
+#include <algine/core/shader/ShaderCreator.h>
+#include <algine/core/shader/ShaderProgramCreator.h>
+#include <algine/core/Engine.h>
+
+#include <algine/std/model/Shape.h>
+#include <algine/std/model/ModelCreator.h>
+#include <algine/std/model/Model.h>
+
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <cmath>
+
+#include "KernelAnimator.h"
+#include "Simd.h"
+#include "constants.h"
+
+using namespace algine;
+using namespace std;
+
+/**
+ * Usage: anim_bench [frames]
+ * Samples each clip of the man and astroboy models by the engine's Animator
+ * (as the example did before the kernels: animate, then copy the bones of the clip)
+ * and by KernelAnimator, and prints the time per clip sample and the largest
+ * difference of the bone matrices.
+ * The engine creates models with their GL buffers, so it opens a hidden window;
+ * must be run from the repository root, like examples
+ */
+namespace {
+float maxDifference(const KernelAnimator::Bones &lhs, const KernelAnimator::Bones &rhs) {
+    float difference = 0;
+
+    for (size_t i = 0; i < lhs.size(); i++)
+        for (int column = 0; column < 4; column++)
+            for (int row = 0; row < 4; row++)
+                difference = max(difference, fabs(lhs[i][column][row] - rhs[i][column][row]));
+
+    return difference;
+}
+}
+
+int main(int argc, char *argv[]) {
+    int framesCount = argc > 1 ? stoi(argv[1]) : 200;
+
+    Engine::init();
+
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    Window window("anim_bench", 64, 64);
+
+    // public programs which are referenced by inputLayoutShapeLocations
+    ShaderCreator::setGlobalIncludePaths({
+        algineResources,
+        resources "shaders"
+    });
+
+    for (auto name : {"Color", "PointShadow"}) {
+        ShaderProgramCreator creator;
+        creator.importFromFile(string(resources "programs/") + name + ".conf.json");
+        creator.create();
+    }
+
+    const char *modelPaths[] = {
+        resources "models/man/man.json",
+        resources "models/astroboy/astroboy_walk.json"
+    };
+
+    constexpr float FrameTime = 1.0f / 60.0f;
+
+    using Clock = chrono::steady_clock;
+
+    cout << "simd: " << simdName() << ", frames: " << framesCount << "\n";
+
+    for (auto path : modelPaths) {
+        ModelCreator creator;
+        creator.importFromFile(path);
+
+        auto model = creator.get();
+        auto &shape = model->getShape();
+        auto animator = model->getAnimator();
+
+        if (animator == nullptr || shape->getAnimationsAmount() == 0) {
+            cerr << path << " has no animations\n";
+            continue;
+        }
+
+        KernelAnimator kernels;
+        kernels.init(shape);
+
+        uint clipsCount = kernels.getClipsCount();
+
+        KernelAnimator::Bones animatorBones, kernelsBones;
+
+        auto animate = [&](uint clip, float time) {
+            animator->setAnimationIndex(clip);
+            animator->animate(time);
+
+            auto &bones = shape->getAnimation(clip).getBones();
+            animatorBones.resize(bones.size());
+
+            for (uint i = 0; i < bones.size(); i++) {
+                animatorBones[i] = bones[i];
+            }
+        };
+
+        auto animateKernels = [&](uint clip, float time) {
+            kernels.animate(clip, time, kernelsBones);
+        };
+
+        auto measure = [&](auto &&sample) {
+            auto start = Clock::now();
+
+            for (int frame = 0; frame < framesCount; frame++)
+                for (uint clip = 0; clip < clipsCount; clip++)
+                    sample(clip, static_cast<float>(frame) * FrameTime);
+
+            chrono::duration<double, nano> elapsed = Clock::now() - start;
+
+            return elapsed.count() / (framesCount * clipsCount);
+        };
+
+        double animatorTime = measure(animate);
+        double kernelsTime = measure(animateKernels);
+
+        float difference = 0;
+
+        for (uint clip = 0; clip < clipsCount; clip++) {
+            for (float time : {0.0f, 0.37f, 1.21f, 1.99f}) {
+                animate(clip, time);
+                animateKernels(clip, time);
+                difference = max(difference, maxDifference(animatorBones, kernelsBones));
+            }
+        }
+
+        cout << fixed << setprecision(1);
+        cout << path << ": clips: " << clipsCount << ", bones: " << kernels.getBonesCount() << "\n";
+        cout << "  animator: " << animatorTime << " ns / clip sample\n";
+        cout << "  kernels:  " << kernelsTime << " ns / clip sample\n";
+        cout << setprecision(2) << "  speedup:  " << animatorTime / kernelsTime << "x\n";
+        cout << scientific << "  max bone matrix difference: " << difference << "\n" << defaultfloat;
+    }
+
+    return 0;
+}
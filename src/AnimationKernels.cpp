@@ -0,0 +1,350 @@
+#include "AnimationKernels.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace AnimationKernels {
+namespace {
+using C = PoseSoA::Component;
+
+constexpr C LinearComponents[] = {C::Tx, C::Ty, C::Tz, C::Sx, C::Sy, C::Sz};
+
+// scalar helpers, used to build the clips
+
+template<typename T>
+float findChannelKey(const vector<T> &keys, float time, unsigned &index) {
+    if (keys.size() < 2 || time <= keys.front().time) {
+        index = 0;
+        return 0.0f;
+    }
+
+    if (time >= keys.back().time) {
+        index = static_cast<unsigned>(keys.size() - 2);
+        return 1.0f;
+    }
+
+    auto it = upper_bound(keys.begin(), keys.end(), time, [](float t, const T &key) {
+        return t < key.time;
+    });
+
+    index = static_cast<unsigned>(it - keys.begin() - 1);
+
+    return (time - keys[index].time) / (keys[index + 1].time - keys[index].time);
+}
+
+void slerp(const float *q0, const float *q1, float t, float *out) {
+    float dot = q0[0] * q1[0] + q0[1] * q1[1] + q0[2] * q1[2] + q0[3] * q1[3];
+    float sign = 1.0f;
+
+    if (dot < 0.0f) {
+        dot = -dot;
+        sign = -1.0f;
+    }
+
+    float k0 = 1.0f - t;
+    float k1 = t;
+
+    if (dot < 0.9995f) {
+        float angle = acos(dot);
+        float invSin = 1.0f / sin(angle);
+        k0 = sin(k0 * angle) * invSin;
+        k1 = sin(k1 * angle) * invSin;
+    }
+
+    for (int i = 0; i < 4; i++)
+        out[i] = q0[i] * k0 + q1[i] * k1 * sign;
+
+    if (dot >= 0.9995f) {
+        float invLength = 1.0f / sqrt(out[0] * out[0] + out[1] * out[1] + out[2] * out[2] + out[3] * out[3]);
+
+        for (int i = 0; i < 4; i++) {
+            out[i] *= invLength;
+        }
+    }
+}
+
+void evaluate(const vector<Key> &keys, float time, int components, bool rotation, float *out) {
+    if (keys.empty())
+        return;
+
+    unsigned index;
+    float t = findChannelKey(keys, time, index);
+
+    if (keys.size() == 1) {
+        copy_n(keys[0].value, components, out);
+    } else if (rotation) {
+        slerp(keys[index].value, keys[index + 1].value, t, out);
+    } else {
+        for (int i = 0; i < components; i++) {
+            const float a = keys[index].value[i];
+            out[i] = a + (keys[index + 1].value[i] - a) * t;
+        }
+    }
+}
+
+/**
+ * Local transformation of the channel: translation, rotation (xyzw), scale
+ */
+void evaluate(const Channel &channel, float time, float *trs) {
+    float identity[] = {0, 0, 0, 0, 0, 0, 1, 1, 1, 1};
+    copy_n(identity, PoseSoA::ComponentsCount, trs);
+
+    evaluate(channel.positions, time, 3, false, trs + C::Tx);
+    evaluate(channel.rotations, time, 4, true, trs + C::Qx);
+    evaluate(channel.scales, time, 3, false, trs + C::Sx);
+}
+
+// SIMD helpers
+
+/**
+ * Interpolates the bones <code>[bone, bone + 4)</code> of two poses in the PoseSoA layout
+ */
+inline void interpolateBlock(const float *lhs, const float *rhs, float4 t, unsigned stride, unsigned bone, float *out) {
+    for (auto c : LinearComponents) {
+        unsigned offset = c * stride + bone;
+        float4 a = load4(lhs + offset);
+        store4(out + offset, madd4(load4(rhs + offset) - a, t, a));
+    }
+
+    unsigned qx = C::Qx * stride + bone;
+    unsigned qy = C::Qy * stride + bone;
+    unsigned qz = C::Qz * stride + bone;
+    unsigned qw = C::Qw * stride + bone;
+
+    float4 ax = load4(lhs + qx), ay = load4(lhs + qy), az = load4(lhs + qz), aw = load4(lhs + qw);
+    float4 bx = load4(rhs + qx), by = load4(rhs + qy), bz = load4(rhs + qz), bw = load4(rhs + qw);
+
+    float4 dot = ax * bx + ay * by + az * bz + aw * bw;
+
+    // shortest path
+    bx = mulSign4(bx, dot);
+    by = mulSign4(by, dot);
+    bz = mulSign4(bz, dot);
+    bw = mulSign4(bw, dot);
+
+    // nlerp with the corrected factor, see "Approximating slerp" by A. Kapoulkine
+    float4 d = abs4(dot);
+    float4 ka = madd4(d, madd4(d, madd4(d, splat4(-1.43519f), splat4(3.55645f)), splat4(-3.2452f)), splat4(1.0904f));
+    float4 kb = madd4(d, madd4(d, splat4(0.215638f), splat4(-1.06021f)), splat4(0.848013f));
+    float4 th = t - splat4(0.5f);
+    float4 k = madd4(ka * th, th, kb);
+    float4 ot = madd4(t * th * (t - splat4(1.0f)), k, t);
+
+    float4 rx = madd4(bx - ax, ot, ax);
+    float4 ry = madd4(by - ay, ot, ay);
+    float4 rz = madd4(bz - az, ot, az);
+    float4 rw = madd4(bw - aw, ot, aw);
+
+    float4 invLength = rsqrt4(rx * rx + ry * ry + rz * rz + rw * rw);
+
+    store4(out + qx, rx * invLength);
+    store4(out + qy, ry * invLength);
+    store4(out + qz, rz * invLength);
+    store4(out + qw, rw * invLength);
+}
+
+inline void multiply(const Mat4 &a, const Mat4 &b, Mat4 &out) {
+    float4 a0 = load4(a.m);
+    float4 a1 = load4(a.m + 4);
+    float4 a2 = load4(a.m + 8);
+    float4 a3 = load4(a.m + 12);
+
+    float4 r[4];
+
+    for (int j = 0; j < 4; j++) {
+        const float *col = b.m + j * 4;
+        r[j] = a0 * splat4(col[0]) + a1 * splat4(col[1]) + a2 * splat4(col[2]) + a3 * splat4(col[3]);
+    }
+
+    for (int j = 0; j < 4; j++) {
+        store4(out.m + j * 4, r[j]);
+    }
+}
+}
+
+Mat4 Mat4::identity() {
+    return {{1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1}};
+}
+
+Mat4 operator*(const Mat4 &a, const Mat4 &b) {
+    Mat4 r {};
+
+    for (int j = 0; j < 4; j++) {
+        for (int i = 0; i < 4; i++) {
+            float sum = 0;
+
+            for (int k = 0; k < 4; k++)
+                sum += a.m[k * 4 + i] * b.m[j * 4 + k];
+
+            r.m[j * 4 + i] = sum;
+        }
+    }
+
+    return r;
+}
+
+void PoseSoA::resize(unsigned count) {
+    if (bonesCount == count && !data.empty())
+        return;
+
+    bonesCount = count;
+    paddedCount = (count + 3) & ~3u;
+    data.assign(ComponentsCount * paddedCount, 0.0f);
+
+    // padding lanes hold identity, so the normalization stays finite
+    fill_n(get(Qw), paddedCount, 1.0f);
+    fill_n(get(Sx), paddedCount * 3, 1.0f);
+}
+
+void ClipSoA::build(const vector<Channel> &channels) {
+    m_bonesCount = static_cast<unsigned>(channels.size());
+    m_paddedCount = (m_bonesCount + 3) & ~3u;
+    m_times.clear();
+
+    for (auto &channel : channels)
+        for (auto keys : {&channel.positions, &channel.rotations, &channel.scales})
+            for (auto &key : *keys)
+                m_times.emplace_back(key.time);
+
+    sort(m_times.begin(), m_times.end());
+    m_times.erase(unique(m_times.begin(), m_times.end()), m_times.end());
+
+    if (m_times.empty())
+        m_times.emplace_back(0.0f);
+
+    PoseSoA key;
+    key.resize(m_bonesCount);
+
+    auto keySize = key.data.size();
+    m_keys.resize(m_times.size() * keySize);
+
+    for (size_t k = 0; k < m_times.size(); k++) {
+        for (unsigned bone = 0; bone < m_bonesCount; bone++) {
+            float trs[PoseSoA::ComponentsCount];
+            evaluate(channels[bone], m_times[k], trs);
+
+            for (int c = 0; c < PoseSoA::ComponentsCount; c++) {
+                key.data[c * m_paddedCount + bone] = trs[c];
+            }
+        }
+
+        copy(key.data.begin(), key.data.end(), m_keys.begin() + k * keySize);
+    }
+}
+
+unsigned ClipSoA::getBonesCount() const {
+    return m_bonesCount;
+}
+
+unsigned ClipSoA::getKeysCount() const {
+    return static_cast<unsigned>(m_times.size());
+}
+
+const vector<float>& ClipSoA::getTimes() const {
+    return m_times;
+}
+
+const float* ClipSoA::getKey(unsigned index) const {
+    return m_keys.data() + index * PoseSoA::ComponentsCount * m_paddedCount;
+}
+
+float findKey(const vector<float> &times, float time, unsigned &index) {
+    if (times.size() < 2 || time <= times.front()) {
+        index = 0;
+        return 0.0f;
+    }
+
+    if (time >= times.back()) {
+        index = static_cast<unsigned>(times.size() - 2);
+        return 1.0f;
+    }
+
+    index = static_cast<unsigned>(upper_bound(times.begin(), times.end(), time) - times.begin() - 1);
+
+    return (time - times[index]) / (times[index + 1] - times[index]);
+}
+
+void sampleClip(const ClipSoA &clip, float time, PoseSoA &pose) {
+    pose.resize(clip.getBonesCount());
+
+    if (clip.getKeysCount() < 2) {
+        copy_n(clip.getKey(0), pose.data.size(), pose.data.begin());
+        return;
+    }
+
+    unsigned index;
+    float4 t = splat4(findKey(clip.getTimes(), time, index));
+
+    const float *lhs = clip.getKey(index);
+    const float *rhs = clip.getKey(index + 1);
+
+    for (unsigned bone = 0; bone < pose.paddedCount; bone += 4) {
+        interpolateBlock(lhs, rhs, t, pose.paddedCount, bone, pose.data.data());
+    }
+}
+
+void blendPoses(const PoseSoA &lhs, const PoseSoA &rhs, float factor, PoseSoA &out) {
+    out.resize(lhs.bonesCount);
+
+    float4 t = splat4(factor);
+
+    for (unsigned bone = 0; bone < out.paddedCount; bone += 4) {
+        interpolateBlock(lhs.data.data(), rhs.data.data(), t, out.paddedCount, bone, out.data.data());
+    }
+}
+
+void composeMatrices(const PoseSoA &pose, Mat4 *local) {
+    const float4 one = splat4(1.0f);
+
+    for (unsigned bone = 0; bone < pose.bonesCount; bone += 4) {
+        auto load = [&](C c) { return load4(pose.get(c) + bone); };
+
+        float4 qx = load(C::Qx), qy = load(C::Qy), qz = load(C::Qz), qw = load(C::Qw);
+        float4 sx = load(C::Sx), sy = load(C::Sy), sz = load(C::Sz);
+
+        float4 x2 = qx + qx, y2 = qy + qy, z2 = qz + qz;
+        float4 xx = qx * x2, yy = qy * y2, zz = qz * z2;
+        float4 xy = qx * y2, xz = qx * z2, yz = qy * z2;
+        float4 wx = qw * x2, wy = qw * y2, wz = qw * z2;
+
+        // columns of T * R * S, component-major: cols[column][row]
+        float4 cols[4][4] = {
+            {(one - (yy + zz)) * sx, (xy + wz) * sx, (xz - wy) * sx, splat4(0.0f)},
+            {(xy - wz) * sy, (one - (xx + zz)) * sy, (yz + wx) * sy, splat4(0.0f)},
+            {(xz + wy) * sz, (yz - wx) * sz, (one - (xx + yy)) * sz, splat4(0.0f)},
+            {load(C::Tx), load(C::Ty), load(C::Tz), one}
+        };
+
+        // to bone-major: cols[column][lane]
+        for (auto &col : cols)
+            transpose4(col[0], col[1], col[2], col[3]);
+
+        unsigned lanes = min(4u, pose.bonesCount - bone);
+
+        for (unsigned lane = 0; lane < lanes; lane++) {
+            for (int column = 0; column < 4; column++) {
+                store4(local[bone + lane].m + column * 4, cols[column][lane]);
+            }
+        }
+    }
+}
+
+void concatenateHierarchy(const int *parents, const Mat4 *local, const Mat4 *offsets, const Mat4 &globalInverse,
+                          unsigned count, Mat4 *global, Mat4 *palette)
+{
+    for (unsigned i = 0; i < count; i++) {
+        if (parents[i] < 0) {
+            global[i] = local[i];
+        } else {
+            multiply(global[parents[i]], local[i], global[i]);
+        }
+
+        Mat4 bone;
+        multiply(globalInverse, global[i], bone);
+        multiply(bone, offsets[i], palette[i]);
+    }
+}
+}
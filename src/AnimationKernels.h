@@ -0,0 +1,117 @@
+#ifndef ALGINE_EXAMPLES_ANIMATIONKERNELS_H
+#define ALGINE_EXAMPLES_ANIMATIONKERNELS_H
+
+#include <vector>
+
+/**
+ * Structure-of-arrays animation sampling: key lookup, quaternion slerp,
+ * TRS composition and hierarchy concatenation over 4 bones per instruction
+ * (SSE, NEON or scalar fallback, see Simd.h).
+ * Kernels don't depend on the engine, the shapes are converted by KernelAnimator
+ */
+namespace AnimationKernels {
+/**
+ * Column-major, the same layout as glm::mat4
+ */
+struct alignas(16) Mat4 {
+    float m[16];
+
+    static Mat4 identity();
+};
+
+Mat4 operator*(const Mat4 &a, const Mat4 &b);
+
+struct Key {
+    float time;
+    float value[4]; // xyz, or xyzw for rotations
+};
+
+/**
+ * Keys of one bone, sorted by time
+ */
+struct Channel {
+    std::vector<Key> positions;
+    std::vector<Key> rotations;
+    std::vector<Key> scales;
+};
+
+/**
+ * Local transformations of the bones, component-major:
+ * <code>data[component * paddedCount + bone]</code>
+ */
+struct PoseSoA {
+    enum Component {
+        Tx, Ty, Tz,
+        Qx, Qy, Qz, Qw,
+        Sx, Sy, Sz,
+        ComponentsCount
+    };
+
+    unsigned bonesCount = 0;
+    unsigned paddedCount = 0;
+    std::vector<float> data;
+
+    void resize(unsigned count);
+
+    float* get(Component component) { return data.data() + component * paddedCount; }
+    const float* get(Component component) const { return data.data() + component * paddedCount; }
+};
+
+/**
+ * Clip, which channels are resampled at the union of all their key times:
+ * all bones share one key lookup per sample, and, since the keys are only
+ * added, linear interpolation of the resampled clip is exact
+ */
+class ClipSoA {
+public:
+    void build(const std::vector<Channel> &channels);
+
+    unsigned getBonesCount() const;
+    unsigned getKeysCount() const;
+    const std::vector<float>& getTimes() const;
+
+    /**
+     * @return key <code>index</code> in the PoseSoA layout
+     */
+    const float* getKey(unsigned index) const;
+
+private:
+    unsigned m_bonesCount = 0;
+    unsigned m_paddedCount = 0;
+    std::vector<float> m_times;
+    std::vector<float> m_keys;
+};
+
+/**
+ * Finds the key pair around <code>time</code>, clamped to the clip
+ * @return factor between the keys <code>index</code> and <code>index + 1</code>
+ */
+float findKey(const std::vector<float> &times, float time, unsigned &index);
+
+/**
+ * Interpolates the clip at <code>time</code>. Rotations are interpolated by
+ * nlerp with a polynomial correction of the factor, which closely
+ * follows slerp without the trigonometry
+ */
+void sampleClip(const ClipSoA &clip, float time, PoseSoA &pose);
+
+/**
+ * Blends two poses with the same bones count; pose <code>out</code> may alias any of them
+ */
+void blendPoses(const PoseSoA &lhs, const PoseSoA &rhs, float factor, PoseSoA &out);
+
+/**
+ * <code>local[i] = T * R * S</code>
+ */
+void composeMatrices(const PoseSoA &pose, Mat4 *local);
+
+/**
+ * <code>global[i] = global[parents[i]] * local[i]</code>,
+ * <code>palette[i] = globalInverse * global[i] * offsets[i]</code>.
+ * Parents must precede their children, root has parent -1
+ */
+void concatenateHierarchy(const int *parents, const Mat4 *local, const Mat4 *offsets, const Mat4 &globalInverse,
+                          unsigned count, Mat4 *global, Mat4 *palette);
+}
+
+#endif //ALGINE_EXAMPLES_ANIMATIONKERNELS_H
@@ -0,0 +1,260 @@
+#include "AnimationLod.h"
+
+#include <algine/std/model/Model.h>
+
+#include <nlohmann/json.hpp>
+
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <cmath>
+
+using namespace std;
+using json = nlohmann::json;
+
+namespace {
+AnimationLod::Level readLevel(const json &config, AnimationLod::Level level) {
+    level.screenSize = config.value("screenSize", level.screenSize);
+    level.rate = config.value("rate", level.rate);
+    level.interpolate = config.value("interpolate", level.interpolate);
+    level.freeze = config.value("freeze", level.freeze);
+
+    return level;
+}
+}
+
+bool AnimationLod::loadConfig(const string &modelConfigPath, Config &config) {
+    ifstream file(modelConfigPath);
+
+    if (!file.is_open())
+        return false;
+
+    auto modelConfig = json::parse(file, nullptr, false);
+
+    if (modelConfig.is_discarded() || !modelConfig.contains("animationLod"))
+        return false;
+
+    auto &lodConfig = modelConfig["animationLod"];
+
+    config = {};
+
+    if (lodConfig.contains("levels")) {
+        for (auto &level : lodConfig["levels"]) {
+            config.levels.emplace_back(readLevel(level, {}));
+        }
+    }
+
+    if (lodConfig.contains("culled"))
+        config.culled = readLevel(lodConfig["culled"], config.culled);
+
+    sort(config.levels.begin(), config.levels.end(), [](const Level &lhs, const Level &rhs) {
+        return lhs.screenSize > rhs.screenSize;
+    });
+
+    return true;
+}
+
+void AnimationLod::add(const ModelPtr &model, const AABB &bounds, const Config &config) {
+    if (find(model)) {
+        cerr << "AnimationLod: model is already added\n";
+        return;
+    }
+
+    auto entry = make_unique<Entry>();
+    entry->model = model;
+    entry->bounds = bounds;
+    entry->config = config;
+    entry->source = model->getBones();
+    entry->bones = *entry->source;
+
+    model->setBones(&entry->bones);
+
+    m_entries.emplace_back(std::move(entry));
+}
+
+bool AnimationLod::update(float time, const glm::mat4 &view, const glm::mat4 &projection) {
+    m_stats = {};
+
+    // the same time - the same bones, nothing is planned
+    if (time == m_time) {
+        for (auto &entry : m_entries)
+            plan(*entry, {0.0f, 0.0f, false, true}, time);
+
+        return false;
+    }
+
+    m_time = time;
+
+    Frustum frustum(projection * view);
+
+    static const Level fullRate;
+
+    bool changed = false;
+
+    for (auto &entry : m_entries) {
+        auto box = entry->bounds.transform(entry->model->transformation());
+
+        const Level *level = &entry->config.culled;
+
+        if (frustum.intersects(box)) {
+            auto center = (box.min + box.max) * 0.5f;
+            auto radius = glm::length(box.max - box.min) * 0.5f;
+            auto depth = -(view * glm::vec4(center, 1.0f)).z;
+
+            // projected diameter / viewport height
+            float screenSize = depth <= radius ? 1.0f : radius * projection[1][1] / depth;
+
+            level = &fullRate;
+
+            for (auto &l : entry->config.levels) {
+                if (screenSize >= l.screenSize) {
+                    level = &l;
+                    break;
+                }
+            }
+        }
+
+        plan(*entry, *level, time);
+
+        if (level->freeze && !entry->write)
+            ++m_stats.frozen;
+
+        changed |= entry->write;
+    }
+
+    return changed;
+}
+
+void AnimationLod::plan(Entry &entry, const Level &level, float time) {
+    entry.shift = false;
+    entry.samplePrev = false;
+    entry.sampleNext = false;
+    entry.write = false;
+    entry.interpolate = false;
+
+    // frozen models still need their first pose
+    if (level.freeze && entry.version != 0)
+        return;
+
+    if (level.rate <= 0.0f || level.freeze) {
+        entry.sampleNext = true;
+        entry.nextTime = time;
+        entry.prevSample = entry.nextSample = -1; // not on the grid
+        entry.write = true;
+        ++m_stats.evaluated;
+        return;
+    }
+
+    if (entry.rate != level.rate) {
+        entry.rate = level.rate;
+        entry.prevSample = entry.nextSample = -1;
+    }
+
+    auto sample = static_cast<int64_t>(floor(time * level.rate));
+    auto sampleTime = [&](int64_t index) { return static_cast<float>(index) / level.rate; };
+
+    if (!level.interpolate) {
+        if (entry.nextSample != sample) {
+            entry.sampleNext = true;
+            entry.nextTime = sampleTime(sample);
+            entry.prevSample = -1;
+            entry.nextSample = sample;
+            entry.write = true;
+            ++m_stats.evaluated;
+        }
+
+        return;
+    }
+
+    // bones are interpolated between the samples around the time,
+    // so the next one is sampled ahead, once per interval
+    if (entry.nextSample == sample) {
+        entry.shift = true;
+    } else if (entry.nextSample != sample + 1) {
+        entry.samplePrev = true;
+        entry.prevTime = sampleTime(sample);
+        ++m_stats.evaluated;
+    }
+
+    if (entry.nextSample != sample + 1) {
+        entry.sampleNext = true;
+        entry.nextTime = sampleTime(sample + 1);
+        ++m_stats.evaluated;
+    }
+
+    entry.prevSample = sample;
+    entry.nextSample = sample + 1;
+    entry.write = true;
+    entry.interpolate = true;
+    entry.factor = time * level.rate - static_cast<float>(sample);
+
+    ++m_stats.interpolated;
+}
+
+void AnimationLod::invalidate(const ModelPtr &model) {
+    if (auto entry = find(model); entry) {
+        entry->prevSample = entry->nextSample = -1;
+        m_time = -1.0f;
+    }
+}
+
+bool AnimationLod::animate(const ModelPtr &model, const Evaluator &evaluate) {
+    auto entry = find(model);
+
+    if (!entry)
+        return false;
+
+    if (entry->shift)
+        swap(entry->prev, entry->next);
+
+    if (entry->samplePrev) {
+        evaluate(entry->prevTime);
+        snapshot(*entry->source, entry->prev);
+    }
+
+    if (entry->sampleNext) {
+        evaluate(entry->nextTime);
+        snapshot(*entry->source, entry->next);
+    }
+
+    if (!entry->write)
+        return true;
+
+    auto &bones = entry->bones;
+    auto &next = entry->next;
+
+    for (uint i = 0; i < next.size(); i++) {
+        bones[i] = entry->interpolate ? entry->prev[i] + (next[i] - entry->prev[i]) * entry->factor : next[i];
+    }
+
+    ++entry->version;
+
+    return true;
+}
+
+uint64_t AnimationLod::getBonesVersion(const ModelPtr &model, uint64_t fallback) const {
+    auto entry = find(model);
+    return entry ? entry->version : fallback;
+}
+
+const AnimationLod::Stats& AnimationLod::getStats() const {
+    return m_stats;
+}
+
+AnimationLod::Entry* AnimationLod::find(const ModelPtr &model) const {
+    for (auto &entry : m_entries)
+        if (entry->model == model)
+            return entry.get();
+
+    return nullptr;
+}
+
+void AnimationLod::snapshot(const BonesStorage &bones, vector<glm::mat4> &pose) {
+    pose.resize(bones.size());
+
+    for (uint i = 0; i < pose.size(); i++) {
+        pose[i] = bones[i];
+    }
+}
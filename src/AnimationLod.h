@@ -0,0 +1,145 @@
+#ifndef ALGINE_EXAMPLES_ANIMATIONLOD_H
+#define ALGINE_EXAMPLES_ANIMATIONLOD_H
+
+#include <algine/std/animation/BonesStorage.h>
+#include <algine/std/model/ModelPtr.h>
+#include <algine/types.h>
+
+#include <glm/mat4x4.hpp>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "Bounds.h"
+
+using namespace algine;
+
+/**
+ * Animation level of detail of the skinned models. Level is chosen by the
+ * projected height of the model's bounding sphere (fraction of the viewport height);
+ * lower levels sample the animation at a reduced rate and interpolate the bones
+ * between the samples, or freeze them. Configured by <code>animationLod</code>
+ * in the model config, next to <code>activatedAnimations</code>:
+ * <pre>
+ * "animationLod": {
+ *     "levels": [
+ *         {"screenSize": 0.3},
+ *         {"screenSize": 0.1, "rate": 20},
+ *         {"screenSize": 0.0, "rate": 8, "interpolate": false}
+ *     ],
+ *     "culled": {"freeze": true}
+ * }
+ * </pre>
+ * Models without it are animated every frame, as before
+ */
+class AnimationLod {
+public:
+    struct Level {
+        float screenSize = 0.0f; // the level is used from this size
+        float rate = 0.0f; // samples per second, 0 - every frame
+        bool interpolate = true;
+        bool freeze = false;
+    };
+
+    struct Config {
+        std::vector<Level> levels; // by descending screenSize
+        Level culled {0.0f, 0.0f, false, true};
+    };
+
+    /**
+     * Sum over the registered models in the last update
+     */
+    struct Stats {
+        uint evaluated = 0; // animation samples
+        uint interpolated = 0;
+        uint frozen = 0;
+    };
+
+    /**
+     * Animates the model at <code>time</code>, so its source bones hold the pose
+     */
+    using Evaluator = std::function<void(float time)>;
+
+public:
+    /**
+     * @return false if the model config has no <code>animationLod</code>
+     */
+    static bool loadConfig(const std::string &modelConfigPath, Config &config);
+
+    /**
+     * The model's current bones become the source, which is written by the evaluator;
+     * the model gets the LOD bones instead
+     * @param bounds bounds of the model's shape, in the model space
+     */
+    void add(const ModelPtr &model, const AABB &bounds, const Config &config);
+
+    /**
+     * Chooses the levels and plans the samples. Must be called before each <code>animate</code>
+     * @return true if bones of any model will change
+     */
+    bool update(float time, const glm::mat4 &view, const glm::mat4 &projection);
+
+    /**
+     * Forces the model to be sampled again by the next update, e.g. when
+     * its bones are changed not by the animation time
+     */
+    void invalidate(const ModelPtr &model);
+
+    /**
+     * Executes the planned samples of the model and writes its bones.
+     * Different models may be animated concurrently
+     * @return false if the model is not registered
+     */
+    bool animate(const ModelPtr &model, const Evaluator &evaluate);
+
+    /**
+     * @return version of the model's bones, changed each time when they are written,
+     * or <code>fallback</code> if the model is not registered
+     */
+    uint64_t getBonesVersion(const ModelPtr &model, uint64_t fallback) const;
+
+    const Stats& getStats() const;
+
+private:
+    struct Entry {
+        ModelPtr model;
+        AABB bounds;
+        Config config;
+        const BonesStorage *source;
+        BonesStorage bones;
+
+        // poses at the samples prevSample / rate and nextSample / rate, -1 - none
+        std::vector<glm::mat4> prev, next;
+        int64_t prevSample = -1;
+        int64_t nextSample = -1;
+        float rate = 0.0f;
+
+        // planned by update: shift next to prev, then sample prev and / or next
+        bool shift = false;
+        bool samplePrev = false;
+        bool sampleNext = false;
+        float prevTime = 0.0f;
+        float nextTime = 0.0f;
+        bool write = false;
+        bool interpolate = false;
+        float factor = 0.0f;
+
+        uint64_t version = 0;
+    };
+
+    Entry* find(const ModelPtr &model) const;
+
+    void plan(Entry &entry, const Level &level, float time);
+
+    static void snapshot(const BonesStorage &bones, std::vector<glm::mat4> &pose);
+
+private:
+    std::vector<std::unique_ptr<Entry>> m_entries;
+    float m_time = -1.0f;
+    Stats m_stats;
+};
+
+#endif //ALGINE_EXAMPLES_ANIMATIONLOD_H
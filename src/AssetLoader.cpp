@@ -0,0 +1,551 @@
+#include "AssetLoader.h"
+
+#include <algine/core/texture/Texture2D.h>
+#include <algine/core/texture/TextureCube.h>
+#include <algine/core/PtrMaker.h>
+#include <algine/std/model/ShapeCreator.h>
+#include <algine/std/model/ModelCreator.h>
+#include <algine/std/model/Model.h>
+#include <algine/gl.h>
+
+#include <stb_image.h>
+#include <nlohmann/json.hpp>
+
+#include <unordered_map>
+#include <set>
+#include <algorithm>
+#include <stdexcept>
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstring>
+
+using namespace std;
+
+static bool endsWith(const string &str, const string &suffix) {
+    return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+AssetLoader::AssetLoader(JobSystem &jobSystem)
+    : m_jobSystem(jobSystem),
+      m_loaded(0),
+      m_total(0),
+      m_pixelBuffer(0),
+      m_pixelBufferHead(0) {}
+
+AssetLoader::~AssetLoader() {
+    m_jobSystem.drain();
+
+    for (auto &region : m_pixelRegions)
+        glDeleteSync(static_cast<GLsync>(region.fence));
+
+    if (m_pixelBuffer != 0) {
+        glDeleteBuffers(1, &m_pixelBuffer);
+    }
+}
+
+shared_future<Texture2DPtr> AssetLoader::loadTexture2D(const string &path) {
+    auto promise = make_shared<std::promise<Texture2DPtr>>();
+    auto data = make_shared<Texture2DData>();
+
+    ++m_total;
+
+    m_jobSystem.submit([=]() {
+        bool isRead;
+
+        try {
+            isRead = read(path, *data);
+        } catch (const exception &e) {
+            cerr << "AssetLoader: can't read " << path << ": " << e.what() << "\n";
+            promise->set_exception(current_exception());
+            ++m_loaded;
+            return;
+        }
+
+        if (!isRead) {
+            promise->set_value(nullptr);
+            ++m_loaded;
+            return;
+        }
+
+        enqueue([=]() {
+            Texture2DPtr texture = PtrMaker::make();
+            texture->bind();
+
+            if (data->isKTX) {
+                auto &ktx = data->ktx;
+
+                for (uint level = 0; level < ktx.levels.size(); level++) {
+                    auto width = max(ktx.width >> level, 1u);
+                    auto height = max(ktx.height >> level, 1u);
+                    auto &pixels = ktx.levels[level];
+
+                    if (ktx.isCompressed()) {
+                        glCompressedTexImage2D(GL_TEXTURE_2D, level, ktx.glInternalFormat, width, height, 0,
+                                static_cast<GLsizei>(pixels.size()), pixels.data());
+                    } else {
+                        glTexImage2D(GL_TEXTURE_2D, level, ktx.glInternalFormat, width, height, 0,
+                                ktx.glFormat, ktx.glType, pixels.data());
+                    }
+                }
+
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(ktx.levels.size()) - 1);
+            } else {
+                upload(GL_TEXTURE_2D, data->image);
+                glGenerateMipmap(GL_TEXTURE_2D);
+            }
+
+            if (data->params.empty()) {
+                texture->setParams(Texture2D::defaultParams());
+            } else {
+                for (auto &param : data->params) {
+                    glTexParameteri(GL_TEXTURE_2D, param.first, param.second);
+                }
+            }
+
+            texture->unbind();
+
+            // public textures are reused by the engine's creators, e.g. by the materials
+            if (data->isPublic && Texture2D::getByName(data->name) == nullptr) {
+                texture->setName(data->name);
+                Texture2D::publicObjects.emplace_back(texture);
+            }
+
+            promise->set_value(texture);
+            ++m_loaded;
+        });
+    });
+
+    return promise->get_future().share();
+}
+
+shared_future<TextureCubePtr> AssetLoader::loadTextureCube(const string &path) {
+    auto promise = make_shared<std::promise<TextureCubePtr>>();
+
+    ++m_total;
+
+    // faces are known when the config is read
+    m_jobSystem.submit([=]() {
+        CubeConfig config;
+
+        try {
+            readCubeConfig(path, config);
+        } catch (const exception &e) {
+            cerr << "AssetLoader: can't read " << path << ": " << e.what() << "\n";
+            promise->set_exception(current_exception());
+            ++m_loaded;
+            return;
+        }
+
+        loadCubeFaces(promise, config);
+    });
+
+    return promise->get_future().share();
+}
+
+shared_future<ShapePtr> AssetLoader::loadShape(const string &path) {
+    auto promise = make_shared<std::promise<ShapePtr>>();
+
+    ++m_total;
+
+    // the engine imports the shape and creates its input layouts (VAOs) in the same call,
+    // and registers its public objects without locking, so the import stays on the GL thread
+    enqueue([=]() {
+        try {
+            ShapeCreator creator;
+            creator.importFromFile(path);
+
+            promise->set_value(creator.get());
+        } catch (const exception &e) {
+            cerr << "AssetLoader: can't import " << path << ": " << e.what() << "\n";
+            promise->set_exception(current_exception());
+        }
+
+        ++m_loaded;
+    });
+
+    return promise->get_future().share();
+}
+
+shared_future<ModelPtr> AssetLoader::loadModel(const string &path) {
+    auto promise = make_shared<std::promise<ModelPtr>>();
+
+    ++m_total;
+
+    // the same as loadShape; materials (e.g. inline textures) are created by the same call
+    enqueue([=]() {
+        try {
+            ModelCreator creator;
+            creator.importFromFile(path);
+
+            promise->set_value(creator.get());
+        } catch (const exception &e) {
+            cerr << "AssetLoader: can't import " << path << ": " << e.what() << "\n";
+            promise->set_exception(current_exception());
+        }
+
+        ++m_loaded;
+    });
+
+    return promise->get_future().share();
+}
+
+vector<shared_future<Texture2DPtr>> AssetLoader::loadMaterialTextures(const string &modelPath) {
+    vector<shared_future<Texture2DPtr>> textures;
+
+    ifstream modelFile(modelPath);
+    auto model = nlohmann::json::parse(modelFile, nullptr, false);
+
+    if (model.is_discarded() || !model.contains("shape") || !model["shape"].contains("dump"))
+        return textures;
+
+    auto &shape = model["shape"]["dump"];
+
+    if (!shape.contains("path") || !shape["path"].is_string())
+        return textures;
+
+    // the engine reads the materials from the file with the name of the shape file
+    auto dir = modelPath.substr(0, modelPath.find_last_of("/\\") + 1);
+    auto shapePath = shape["path"].get<string>();
+    auto materialsPath = dir + shapePath.substr(0, shapePath.find_last_of('.')) + ".amtl";
+
+    ifstream materialsFile(materialsPath);
+    auto materials = nlohmann::json::parse(materialsFile, nullptr, false);
+
+    if (materials.is_discarded() || !materials.is_array())
+        return textures;
+
+    // the same config is usually shared by several slots and materials
+    set<string> paths;
+
+    for (auto &material : materials) {
+        if (!material.contains("textures"))
+            continue;
+
+        for (auto &[name, texture] : material["textures"].items()) {
+            if (texture.contains("path") && texture["path"].is_string()) {
+                paths.insert(dir + texture["path"].get<string>());
+            }
+        }
+    }
+
+    for (auto &path : paths)
+        textures.emplace_back(loadTexture2D(path));
+
+    return textures;
+}
+
+void AssetLoader::update(float budget) {
+    using namespace chrono;
+
+    auto start = steady_clock::now();
+
+    do {
+        Task task;
+
+        {
+            lock_guard<mutex> lock(m_mutex);
+
+            if (m_tasks.empty())
+                return;
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+
+        task();
+    } while (budget < 0 || duration<float, milli>(steady_clock::now() - start).count() < budget);
+}
+
+AssetLoader::Progress AssetLoader::getProgress() const {
+    return {m_loaded, m_total};
+}
+
+bool AssetLoader::read(const string &path, Texture2DData &data) {
+    if (endsWith(path, ".ktx")) {
+        data.isKTX = true;
+        return readKTX(path, data.ktx);
+    }
+
+    if (!endsWith(path, ".conf.json"))
+        return decode(path, 0, true, false, data.image);
+
+    ifstream file(path);
+
+    if (!file.is_open()) {
+        cerr << "AssetLoader: can't open " << path << "\n";
+        return false;
+    }
+
+    auto config = nlohmann::json::parse(file, nullptr, false);
+
+    if (config.is_discarded() || !config.contains("file")) {
+        cerr << "AssetLoader: " << path << " is not a texture config\n";
+        return false;
+    }
+
+    if (config.contains("access") && config["access"] == "public" && config.contains("name")) {
+        data.isPublic = true;
+        data.name = config["name"].get<string>();
+    }
+
+    static const unordered_map<string, GLenum> paramNames = {
+        {"minFilter", GL_TEXTURE_MIN_FILTER},
+        {"magFilter", GL_TEXTURE_MAG_FILTER},
+        {"wrapU", GL_TEXTURE_WRAP_S},
+        {"wrapV", GL_TEXTURE_WRAP_T}
+    };
+
+    static const unordered_map<string, GLint> paramValues = {
+        {"nearest", GL_NEAREST},
+        {"linear", GL_LINEAR},
+        {"nearestMipmapNearest", GL_NEAREST_MIPMAP_NEAREST},
+        {"linearMipmapNearest", GL_LINEAR_MIPMAP_NEAREST},
+        {"nearestMipmapLinear", GL_NEAREST_MIPMAP_LINEAR},
+        {"linearMipmapLinear", GL_LINEAR_MIPMAP_LINEAR},
+        {"repeat", GL_REPEAT},
+        {"mirroredRepeat", GL_MIRRORED_REPEAT},
+        {"clampToEdge", GL_CLAMP_TO_EDGE},
+        {"clampToBorder", GL_CLAMP_TO_BORDER}
+    };
+
+    if (config.contains("params")) {
+        for (auto &[name, value] : config["params"].items()) {
+            if (!value.is_string()) {
+                cerr << "AssetLoader: " << path << ": param " << name << " is not a string\n";
+                continue;
+            }
+
+            auto paramName = paramNames.find(name);
+            auto paramValue = paramValues.find(value.get<string>());
+
+            if (paramName != paramNames.end() && paramValue != paramValues.end()) {
+                data.params.emplace_back(paramName->second, paramValue->second);
+            }
+        }
+    }
+
+    // paths are relative to the config
+    auto dir = path.substr(0, path.find_last_of("/\\") + 1);
+    auto &fileConfig = config["file"];
+
+    if (fileConfig.contains("compressed"))
+        return read(dir + fileConfig["compressed"].get<string>(), data);
+
+    return read(dir + fileConfig["path"].get<string>(), data);
+}
+
+void AssetLoader::readCubeConfig(const string &path, CubeConfig &config) {
+    ifstream file(path);
+
+    if (!file.is_open())
+        throw runtime_error("can't open the file");
+
+    static const unordered_map<string, int> formats = {
+        {"red", 1},
+        {"rg", 2},
+        {"rgb", 3},
+        {"rgba", 4}
+    };
+
+    // in the GL_TEXTURE_CUBE_MAP_POSITIVE_X + i order
+    static const char *faceNames[] = {"right", "left", "top", "bottom", "front", "back"};
+
+    // at() and get() throw on the missing or mistyped fields
+    auto json = nlohmann::json::parse(file);
+    auto &fileConfig = json.at("file");
+    auto &paths = fileConfig.at("paths");
+
+    // paths are relative to the config
+    auto dir = path.substr(0, path.find_last_of("/\\") + 1);
+
+    for (uint i = 0; i < 6; i++)
+        config.paths[i] = dir + paths.at(faceNames[i]).get<string>();
+
+    if (json.contains("format")) {
+        auto format = formats.find(json["format"].get<string>());
+
+        if (format == formats.end())
+            throw runtime_error("unsupported format " + json["format"].get<string>());
+
+        config.channels = format->second;
+    }
+
+    if (fileConfig.contains("dataType")) {
+        auto dataType = fileConfig["dataType"].get<string>();
+
+        if (dataType != "ubyte" && dataType != "float")
+            throw runtime_error("unsupported data type " + dataType);
+
+        config.isFloat = dataType == "float";
+    }
+}
+
+void AssetLoader::loadCubeFaces(const shared_ptr<std::promise<TextureCubePtr>> &promise, const CubeConfig &config) {
+    struct Faces {
+        Image images[6];
+        atomic<uint> remaining {6};
+        atomic_bool failed {false};
+    };
+
+    auto faces = make_shared<Faces>();
+
+    // faces are decoded in parallel, the last decoded face schedules the upload
+    for (uint i = 0; i < 6; i++) {
+        m_jobSystem.submit([=]() {
+            if (!decode(config.paths[i], config.channels, false, config.isFloat, faces->images[i]))
+                faces->failed = true;
+
+            if (--faces->remaining != 0)
+                return;
+
+            if (faces->failed) {
+                promise->set_value(nullptr);
+                ++m_loaded;
+                return;
+            }
+
+            enqueue([=]() {
+                TextureCubePtr texture = PtrMaker::make();
+                texture->bind();
+
+                for (uint face = 0; face < 6; face++)
+                    upload(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, faces->images[face]);
+
+                texture->setParams(TextureCube::defaultParams());
+                texture->unbind();
+
+                promise->set_value(texture);
+                ++m_loaded;
+            });
+        });
+    }
+}
+
+bool AssetLoader::decode(const string &path, int channels, bool flip, bool isFloat, Image &image) {
+    void *data;
+
+    if (isFloat) {
+        data = stbi_loadf(path.c_str(), &image.width, &image.height, &image.channels, channels);
+    } else {
+        data = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, channels);
+    }
+
+    if (!data) {
+        cerr << "AssetLoader: can't load " << path << ": " << stbi_failure_reason() << "\n";
+        return false;
+    }
+
+    if (channels != 0)
+        image.channels = channels;
+
+    image.isFloat = isFloat;
+
+    auto pixelSize = isFloat ? sizeof(float) : sizeof(stbi_uc);
+    auto rowSize = static_cast<usize>(image.width * image.channels) * pixelSize;
+    auto src = static_cast<const char*>(data);
+
+    image.pixels.resize(rowSize * image.height);
+
+    // flipped manually, since stb's flip flag is global
+    for (int y = 0; y < image.height; y++) {
+        auto srcRow = flip ? image.height - 1 - y : y;
+        memcpy(&image.pixels[y * rowSize], src + srcRow * rowSize, rowSize);
+    }
+
+    stbi_image_free(data);
+
+    return true;
+}
+
+void AssetLoader::upload(uint target, const Image &image) {
+    constexpr static GLenum formats[] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+    constexpr static GLenum internalFormats[] = {GL_R8, GL_RG8, GL_RGB8, GL_RGBA8};
+    constexpr static GLenum floatInternalFormats[] = {GL_R16F, GL_RG16F, GL_RGB16F, GL_RGBA16F};
+
+    auto channel = image.channels - 1;
+    auto internalFormat = image.isFloat ? floatInternalFormats[channel] : internalFormats[channel];
+    auto type = image.isFloat ? GL_FLOAT : GL_UNSIGNED_BYTE;
+    auto size = image.pixels.size();
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    usize offset;
+
+    if (allocatePixels(size, offset)) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixelBuffer);
+
+        // the region isn't read by the GPU anymore (see allocatePixels),
+        // so the map doesn't have to synchronize
+        auto ptr = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size),
+                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        memcpy(ptr, image.pixels.data(), size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+        glTexImage2D(target, 0, internalFormat, image.width, image.height, 0,
+                formats[channel], type, reinterpret_cast<const void*>(offset));
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        m_pixelRegions.push_back({offset, offset + size, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)});
+    } else {
+        // doesn't fit into the ring
+        glTexImage2D(target, 0, internalFormat, image.width, image.height, 0,
+                formats[channel], type, image.pixels.data());
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+bool AssetLoader::allocatePixels(usize size, usize &offset) {
+    if (size > PixelBufferSize)
+        return false;
+
+    if (m_pixelBuffer == 0) {
+        glGenBuffers(1, &m_pixelBuffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixelBuffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, PixelBufferSize, nullptr, GL_STREAM_DRAW);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    auto isSignaled = [](const PixelRegion &region) {
+        auto status = glClientWaitSync(static_cast<GLsync>(region.fence), 0, 0);
+        return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+    };
+
+    auto release = [this](usize count) {
+        for (usize i = 0; i < count; i++) {
+            glDeleteSync(static_cast<GLsync>(m_pixelRegions.front().fence));
+            m_pixelRegions.pop_front();
+        }
+    };
+
+    // finished transfers
+    while (!m_pixelRegions.empty() && isSignaled(m_pixelRegions.front()))
+        release(1);
+
+    if (m_pixelBufferHead + size > PixelBufferSize)
+        m_pixelBufferHead = 0;
+
+    offset = m_pixelBufferHead;
+
+    // float pixels must be aligned by the component size
+    m_pixelBufferHead = (offset + size + 15) & ~static_cast<usize>(15);
+
+    // regions complete in order, so waiting for the newest overlapping one is enough
+    auto overlapping = find_if(m_pixelRegions.rbegin(), m_pixelRegions.rend(), [&](const PixelRegion &region) {
+        return region.begin < offset + size && offset < region.end;
+    });
+
+    if (overlapping != m_pixelRegions.rend()) {
+        glClientWaitSync(static_cast<GLsync>(overlapping->fence), GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        release(static_cast<usize>(distance(overlapping, m_pixelRegions.rend())));
+    }
+
+    return true;
+}
+
+void AssetLoader::enqueue(Task task) {
+    lock_guard<mutex> lock(m_mutex);
+    m_tasks.emplace_back(std::move(task));
+}
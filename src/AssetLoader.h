@@ -0,0 +1,163 @@
+#ifndef ALGINE_EXAMPLES_ASSETLOADER_H
+#define ALGINE_EXAMPLES_ASSETLOADER_H
+
+#include <algine/core/texture/Texture2DPtr.h>
+#include <algine/core/texture/TextureCubePtr.h>
+#include <algine/std/model/ShapePtr.h>
+#include <algine/std/model/ModelPtr.h>
+#include <algine/types.h>
+
+#include <functional>
+#include <memory>
+#include <future>
+#include <thread>
+#include <string>
+#include <vector>
+#include <array>
+#include <deque>
+#include <mutex>
+#include <atomic>
+
+#include "JobSystem.h"
+#include "KTXFile.h"
+
+using namespace algine;
+
+/**
+ * Loads assets in the background. Images are decoded by the workers of the
+ * job system; GPU uploads are queued and executed on the GL thread by
+ * <code>update</code> within the given time budget. Shapes and models are imported
+ * on the GL thread as well: the engine creates their input layouts in the same call.
+ * Pixels are uploaded through the ring of the pixel buffer, which lives as long
+ * as the loader: each upload fences its region, so the transfers are asynchronous
+ * and the region is reused when the GPU has read it.
+ * Errors (e.g. invalid configs) are reported through the futures.
+ */
+class AssetLoader {
+public:
+    struct Progress {
+        uint loaded = 0;
+        uint total = 0;
+    };
+
+public:
+    explicit AssetLoader(JobSystem &jobSystem);
+
+    /**
+     * Waits for the queued jobs, since they capture the loader.
+     * Assets which aren't uploaded yet are never completed.
+     * Must be called on the GL thread
+     */
+    ~AssetLoader();
+
+    /**
+     * @param path image (decoded by stb_image), KTX file (compressed formats
+     * are uploaded as is, with their mip chains) or texture config (*.conf.json).
+     * Texture configs are loaded from <code>file.compressed</code> if present
+     * (see bake_textures), otherwise from <code>file.path</code>; params are applied
+     */
+    std::shared_future<Texture2DPtr> loadTexture2D(const std::string &path);
+
+    /**
+     * @param path cube texture config (*.conf.json): <code>file.paths</code> of the faces,
+     * <code>format</code> (red, rg, rgb, rgba) and <code>file.dataType</code> (ubyte, float)
+     */
+    std::shared_future<TextureCubePtr> loadTextureCube(const std::string &path);
+
+    std::shared_future<ShapePtr> loadShape(const std::string &path);
+    std::shared_future<ModelPtr> loadModel(const std::string &path);
+
+    /**
+     * Loads the texture configs referenced by <code>path</code> from the materials
+     * of the model (*.amtl next to its shape file). Public textures are registered by name,
+     * so the engine reuses them while creating the model instead of decoding the images again;
+     * this way the materials get the compressed textures (<code>file.compressed</code>).
+     * Must be completed before the model is loaded. Inline (dump) textures are still loaded by the engine
+     */
+    std::vector<std::shared_future<Texture2DPtr>> loadMaterialTextures(const std::string &modelPath);
+
+    /**
+     * Executes queued GL tasks until <code>budget</code> is exceeded.
+     * At least one task is executed per call. Must be called on the GL thread
+     * @param budget in milliseconds, negative - unlimited
+     */
+    void update(float budget);
+
+    /**
+     * Waits for the asset on the GL thread, executing queued GL tasks and jobs
+     */
+    template<typename T>
+    T wait(const std::shared_future<T> &future) {
+        while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            update(-1.0f);
+
+            if (!m_jobSystem.tryRunJob()) {
+                std::this_thread::yield();
+            }
+        }
+
+        return future.get();
+    }
+
+    Progress getProgress() const;
+
+private:
+    struct Image {
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        bool isFloat = false;
+        std::vector<uint8_t> pixels;
+    };
+
+    struct CubeConfig {
+        std::array<std::string, 6> paths;
+        int channels = 3;
+        bool isFloat = false;
+    };
+
+    struct PixelRegion {
+        usize begin;
+        usize end;
+        void *fence;
+    };
+
+    struct Texture2DData {
+        Image image;
+        KTXImage ktx;
+        bool isKTX = false;
+        bool isPublic = false;
+        std::string name;
+        std::vector<std::pair<uint, int>> params; // GL texture parameters
+    };
+
+    using Task = std::function<void()>;
+
+    static bool read(const std::string &path, Texture2DData &data);
+    static void readCubeConfig(const std::string &path, CubeConfig &config);
+    static bool decode(const std::string &path, int channels, bool flip, bool isFloat, Image &image);
+
+    void loadCubeFaces(const std::shared_ptr<std::promise<TextureCubePtr>> &promise, const CubeConfig &config);
+    void upload(uint target, const Image &image);
+    bool allocatePixels(usize size, usize &offset);
+
+    void enqueue(Task task);
+
+private:
+    JobSystem &m_jobSystem;
+
+    mutable std::mutex m_mutex;
+    std::deque<Task> m_tasks; // GL thread tasks
+
+    std::atomic<uint> m_loaded;
+    std::atomic<uint> m_total;
+
+    // GL thread only
+    constexpr static usize PixelBufferSize = 32 * 1024 * 1024;
+
+    uint m_pixelBuffer;
+    usize m_pixelBufferHead;
+    std::deque<PixelRegion> m_pixelRegions; // in flight, from the oldest
+};
+
+#endif //ALGINE_EXAMPLES_ASSETLOADER_H
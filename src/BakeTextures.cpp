@@ -0,0 +1,152 @@
+#include <stb_image.h>
+#include <nlohmann/json.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+
+#include "TextureCompression.h"
+#include "KTXFile.h"
+#include "JobSystem.h"
+
+using namespace std;
+using json = nlohmann::json;
+
+// EXT_texture_compression_s3tc
+constexpr uint CompressedRGB_BC1 = 0x83F0;
+constexpr uint CompressedRGBA_BC3 = 0x83F3;
+constexpr uint BaseRGB = 0x1907;
+constexpr uint BaseRGBA = 0x1908;
+
+/**
+ * Marked by <code>"normalMap": true</code> in the config, or detected by the name
+ * of the image or the texture (e.g. <code>*_NORM.png</code>, <code>norm.png</code>)
+ */
+static bool isNormalMap(const json &config, const string &imagePath) {
+    if (config.contains("normalMap"))
+        return config["normalMap"].get<bool>();
+
+    auto name = imagePath.substr(imagePath.find_last_of("/\\") + 1) + " " + config.value("name", "");
+    transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return tolower(c); });
+
+    return name.find("norm") != string::npos;
+}
+
+static bool bake(const string &configPath) {
+    ifstream configFile(configPath);
+
+    if (!configFile.is_open()) {
+        cerr << "Can't open " << configPath << "\n";
+        return false;
+    }
+
+    json config = json::parse(configFile, nullptr, false);
+    configFile.close();
+
+    if (config.is_discarded() || config.value("type", "") != "texture2d" || !config["file"].contains("path")) {
+        cerr << configPath << " is not a 2D texture config\n";
+        return false;
+    }
+
+    auto dir = configPath.substr(0, configPath.find_last_of("/\\") + 1);
+    auto imagePath = config["file"]["path"].get<string>();
+    bool hasAlpha = config.value("format", "rgb") == "rgba";
+
+    // RGB565 endpoints with 4 palette entries destroy tangent space normals,
+    // and the engine's normal mapping reads all 3 components, so BC5 doesn't fit either
+    if (isNormalMap(config, imagePath)) {
+        if (config["file"].contains("compressed")) {
+            config["file"].erase("compressed");
+            ofstream(configPath) << config.dump(4);
+        }
+
+        cout << configPath + ": normal map, left uncompressed\n";
+
+        return true;
+    }
+
+    int width, height, channels;
+    auto data = stbi_load((dir + imagePath).c_str(), &width, &height, &channels, 4);
+
+    if (!data) {
+        cerr << "Can't load " << dir + imagePath << ": " << stbi_failure_reason() << "\n";
+        return false;
+    }
+
+    // rows are flipped like for the uncompressed textures: first row is the bottom one
+    ImageRGBA image;
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(width * height * 4);
+
+    for (int y = 0; y < height; y++) {
+        copy(data + (height - 1 - y) * width * 4, data + (height - y) * width * 4, &image.pixels[y * width * 4]);
+    }
+
+    stbi_image_free(data);
+
+    KTXImage ktx;
+    ktx.glInternalFormat = hasAlpha ? CompressedRGBA_BC3 : CompressedRGB_BC1;
+    ktx.glBaseInternalFormat = hasAlpha ? BaseRGBA : BaseRGB;
+    ktx.width = image.width;
+    ktx.height = image.height;
+
+    // full mip chain
+    while (true) {
+        ktx.levels.emplace_back(hasAlpha ? encodeBC3(image) : encodeBC1(image));
+
+        if (image.width == 1 && image.height == 1)
+            break;
+
+        image = downsample(image);
+    }
+
+    auto ktxPath = imagePath.substr(0, imagePath.find_last_of('.')) + ".ktx";
+
+    if (!writeKTX(dir + ktxPath, ktx))
+        return false;
+
+    config["file"]["compressed"] = ktxPath;
+
+    ofstream(configPath) << config.dump(4);
+
+    // one write per line, since textures are baked in parallel
+    cout << configPath + ": " + (hasAlpha ? "BC3" : "BC1") + ", " + to_string(width) + "x" + to_string(height) +
+            ", " + to_string(ktx.levels.size()) + " levels\n";
+
+    return true;
+}
+
+/**
+ * Usage: bake_textures texture.conf.json...
+ * Compresses the images of 2D texture configs to BC1 (rgb) or BC3 (rgba)
+ * with full mip chains, writes them to KTX files next to the images and
+ * adds <code>file.compressed</code> to the configs. Normal maps are skipped
+ * (see <code>isNormalMap</code>). Textures are baked in parallel
+ */
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        cerr << "Usage: bake_textures texture.conf.json...\n";
+        return 1;
+    }
+
+    JobSystem jobSystem;
+    JobGraph graph;
+    atomic<int> failed {0};
+
+    for (int i = 1; i < argc; i++) {
+        string path = argv[i];
+
+        graph.add([path, &failed]() {
+            if (!bake(path)) {
+                ++failed;
+            }
+        });
+    }
+
+    graph.run(jobSystem);
+
+    return failed == 0 ? 0 : 1;
+}
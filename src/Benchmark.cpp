@@ -0,0 +1,267 @@
+#include "Benchmark.h"
+
+#include "ExampleChessContent.h"
+
+#include <algine/gl.h>
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+
+using namespace std;
+
+// camera orbits around the board center
+#define constant constexpr static auto
+
+constant cameraOrbitRadius = 16.0f;
+constant cameraOrbitHeight = 10.0f;
+constant cameraPitch = 0.5f; // ~30 degrees
+
+Benchmark::Benchmark(ExampleChessContent *content, const Options &options)
+    : m_content(content),
+      m_options(options) {}
+
+void Benchmark::run() {
+    cout << "Benchmark: " << m_options.warmupFrames << " warmup frames, " << m_options.frames << " frames\n";
+
+    m_frames.clear();
+    m_frames.reserve(m_options.frames);
+    m_shadowCacheStats = {};
+    m_animationLodStats = {};
+
+    m_content->setPassTimer(&m_timer);
+
+    auto &profiler = m_content->getProfiler();
+    profiler.setEnabled(!m_options.trace.empty());
+
+    for (uint i = 0; i < m_options.warmupFrames + m_options.frames; i++) {
+        moveCamera(i);
+        m_content->setTimeOverride(static_cast<float>(i) * m_options.frameTime);
+
+        m_timer.beginFrame();
+        m_content->render();
+        glFinish();
+        m_timer.endFrame();
+
+        if (i < m_options.warmupFrames)
+            continue;
+
+        m_queueStats = m_content->getRenderQueue().getStats();
+        m_cullingStats[0] = m_content->getCullingStats(ExampleChessContent::CullingPass::Color);
+        m_cullingStats[1] = m_content->getCullingStats(ExampleChessContent::CullingPass::PointShadow);
+        m_cullingStats[2] = m_content->getCullingStats(ExampleChessContent::CullingPass::DirShadow);
+
+        auto &shadowCacheStats = m_content->getShadowCacheStats();
+        m_shadowCacheStats.rendered += shadowCacheStats.rendered;
+        m_shadowCacheStats.skipped += shadowCacheStats.skipped;
+
+        auto &animationLodStats = m_content->getAnimationLodStats();
+        m_animationLodStats.evaluated += animationLodStats.evaluated;
+        m_animationLodStats.interpolated += animationLodStats.interpolated;
+        m_animationLodStats.frozen += animationLodStats.frozen;
+
+        FrameTimings timings;
+        timings.frame = m_timer.getFrameTiming();
+
+        for (int p = 0; p < PassTimer::PassesCount; p++)
+            timings.passes[p] = m_timer.getTiming(static_cast<PassTimer::Pass>(p));
+
+        m_frames.emplace_back(timings);
+    }
+
+    m_content->setPassTimer(nullptr);
+    m_content->setTimeOverride(-1.0f);
+
+    if (!m_options.trace.empty()) {
+        profiler.setEnabled(false);
+        profiler.dumpChromeTrace(m_options.trace);
+    }
+
+    cout << "Benchmark done\n";
+}
+
+namespace {
+// driver strings may contain quotes, backslashes or control characters
+string escapeJson(const string &str) {
+    string result;
+    result.reserve(str.size());
+
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char code[7];
+            snprintf(code, sizeof(code), "\\u%04x", c);
+            result += code;
+        } else {
+            result += c;
+        }
+    }
+
+    return result;
+}
+
+void writeStats(ofstream &out, vector<double> values) {
+    if (values.empty()) {
+        out << "{}";
+        return;
+    }
+
+    sort(values.begin(), values.end());
+
+    double sum = 0;
+
+    for (double v : values)
+        sum += v;
+
+    auto percentile = [&](double p) {
+        return values[static_cast<size_t>(p * static_cast<double>(values.size() - 1))];
+    };
+
+    out << "{\"mean\": " << sum / static_cast<double>(values.size())
+        << ", \"min\": " << values.front()
+        << ", \"max\": " << values.back()
+        << ", \"p50\": " << percentile(0.5)
+        << ", \"p95\": " << percentile(0.95)
+        << ", \"p99\": " << percentile(0.99) << "}";
+}
+
+void writeTiming(ofstream &out, const PassTimer::Timing &timing) {
+    out << "{\"cpu\": " << timing.cpu << ", \"gpu\": " << timing.gpu << "}";
+}
+}
+
+void Benchmark::write() const {
+    ofstream out(m_options.output);
+
+    if (!out.is_open()) {
+        cerr << "Benchmark: can't open " << m_options.output << "\n";
+        return;
+    }
+
+    auto glString = [](GLenum name) {
+        auto str = reinterpret_cast<const char*>(glGetString(name));
+        return escapeJson(str ? str : "");
+    };
+
+    auto collect = [&](auto getter) {
+        vector<double> values;
+        values.reserve(m_frames.size());
+
+        for (auto &frame : m_frames)
+            values.push_back(getter(frame));
+
+        return values;
+    };
+
+    out << "{\n";
+    out << "  \"renderer\": \"" << glString(GL_RENDERER) << "\",\n";
+    out << "  \"version\": \"" << glString(GL_VERSION) << "\",\n";
+    out << "  \"pointShadowMode\": \"" << ExampleChessContent::getPointShadowModeName(m_content->getPointShadowMode()) << "\",\n";
+    out << "  \"preSkinning\": " << (m_content->isPreSkinningEnabled() ? "true" : "false") << ",\n";
+    out << "  \"compactGBuffer\": " << (m_content->isCompactGBufferEnabled() ? "true" : "false") << ",\n";
+    out << "  \"ssrMode\": \"" << ExampleChessContent::getSSRModeName(m_content->getSSRMode()) << "\",\n";
+    out << "  \"blur\": {\"mode\": \"" << GaussianBlur::getModeName(m_content->getBlurMode())
+        << "\", \"fetchesPerPixel\": " << m_content->getBlurFetchesPerPixel() << "},\n";
+    out << "  \"width\": " << m_content->width() << ",\n";
+    out << "  \"height\": " << m_content->height() << ",\n";
+    out << "  \"frames\": " << m_frames.size() << ",\n";
+    out << "  \"warmupFrames\": " << m_options.warmupFrames << ",\n";
+    out << "  \"units\": \"ms\",\n";
+
+    // summary
+    out << "  \"summary\": {\n";
+    out << "    \"frame\": {\"cpu\": ";
+    writeStats(out, collect([](const FrameTimings &f) { return f.frame.cpu; }));
+    out << ", \"gpu\": ";
+    writeStats(out, collect([](const FrameTimings &f) { return f.frame.gpu; }));
+    out << "}";
+
+    for (int p = 0; p < PassTimer::PassesCount; p++) {
+        out << ",\n    \"" << PassTimer::getPassName(static_cast<PassTimer::Pass>(p)) << "\": {\"cpu\": ";
+        writeStats(out, collect([p](const FrameTimings &f) { return f.passes[p].cpu; }));
+        out << ", \"gpu\": ";
+        writeStats(out, collect([p](const FrameTimings &f) { return f.passes[p].gpu; }));
+        out << "}";
+    }
+
+    out << "\n  },\n";
+
+    // color pass state changes of the last frame
+    out << "  \"renderQueue\": {"
+        << "\"drawCalls\": " << m_queueStats.drawCalls
+        << ", \"layoutBinds\": " << m_queueStats.layoutBinds
+        << ", \"textureBinds\": " << m_queueStats.textureBinds
+        << ", \"uniformSets\": " << m_queueStats.uniformSets
+        << ", \"modelChanges\": " << m_queueStats.modelChanges
+        << ", \"stateChangesSaved\": " << m_queueStats.getStateChangesSaved() << "},\n";
+
+    // meshes drawn / culled in the last frame
+    out << "  \"culling\": {";
+
+    const char *cullingPasses[] = {"color", "pointShadow", "dirShadow"};
+
+    for (int i = 0; i < 3; i++) {
+        out << (i == 0 ? "" : ", ") << "\"" << cullingPasses[i] << "\": {\"drawn\": " << m_cullingStats[i].drawn
+            << ", \"culled\": " << m_cullingStats[i].culled << "}";
+    }
+
+    out << "},\n";
+
+    // shadow maps rendered / kept from the previous frames
+    out << "  \"shadowCache\": {\"rendered\": " << m_shadowCacheStats.rendered
+        << ", \"skipped\": " << m_shadowCacheStats.skipped << "},\n";
+
+    // animation samples / interpolated / frozen models with animation LOD
+    out << "  \"animationLod\": {\"evaluated\": " << m_animationLodStats.evaluated
+        << ", \"interpolated\": " << m_animationLodStats.interpolated
+        << ", \"frozen\": " << m_animationLodStats.frozen << "},\n";
+
+    // transient post-processing targets and their textures, at the last render size
+    auto &targetStats = m_content->getRenderTargetStats();
+
+    out << "  \"renderTargets\": {\"targets\": " << targetStats.targets
+        << ", \"textures\": " << targetStats.textures
+        << ", \"bytes\": " << targetStats.bytes
+        << ", \"unaliasedBytes\": " << targetStats.unaliasedBytes
+        << ", \"reallocations\": " << targetStats.reallocations << "},\n";
+
+    // per-frame timings
+    out << "  \"perFrame\": [";
+
+    for (size_t i = 0; i < m_frames.size(); i++) {
+        auto &frame = m_frames[i];
+
+        out << (i == 0 ? "\n" : ",\n") << "    {\"frame\": ";
+        writeTiming(out, frame.frame);
+
+        for (int p = 0; p < PassTimer::PassesCount; p++) {
+            out << ", \"" << PassTimer::getPassName(static_cast<PassTimer::Pass>(p)) << "\": ";
+            writeTiming(out, frame.passes[p]);
+        }
+
+        out << "}";
+    }
+
+    out << "\n  ]\n}\n";
+
+    cout << "Benchmark results written to " << m_options.output << "\n";
+}
+
+void Benchmark::moveCamera(uint frame) {
+    float angle = glm::two_pi<float>() * static_cast<float>(frame) / static_cast<float>(m_options.warmupFrames + m_options.frames);
+
+    auto &camera = m_content->getCamera();
+    camera.setPitch(cameraPitch);
+    camera.setYaw(-angle);
+    camera.rotate();
+
+    camera.setPos(glm::sin(angle) * cameraOrbitRadius, cameraOrbitHeight, glm::cos(angle) * cameraOrbitRadius);
+    camera.translate();
+
+    camera.updateMatrix();
+}
@@ -0,0 +1,54 @@
+#ifndef ALGINE_EXAMPLES_BENCHMARK_H
+#define ALGINE_EXAMPLES_BENCHMARK_H
+
+#include "PassTimer.h"
+#include "RenderQueue.h"
+#include "ShadowCache.h"
+#include "AnimationLod.h"
+
+#include <string>
+#include <vector>
+
+class ExampleChessContent;
+
+/**
+ * Renders ExampleChessContent for a fixed amount of frames along
+ * the scripted camera path and writes per-frame and per-pass timings to json.
+ * Animation time is fixed per frame, so runs are reproducible.
+ */
+class Benchmark {
+public:
+    struct Options {
+        uint frames = 600;
+        uint warmupFrames = 30;
+        float frameTime = 1.0f / 60.0f; // simulated time step, in seconds
+        std::string output = "benchmark.json";
+        std::string trace; // Chrome trace of the last frames, optional
+    };
+
+public:
+    Benchmark(ExampleChessContent *content, const Options &options);
+
+    void run();
+    void write() const;
+
+private:
+    void moveCamera(uint frame);
+
+private:
+    struct FrameTimings {
+        PassTimer::Timing frame;
+        PassTimer::Timing passes[PassTimer::PassesCount];
+    };
+
+    ExampleChessContent *m_content;
+    Options m_options;
+    PassTimer m_timer;
+    std::vector<FrameTimings> m_frames;
+    RenderQueue::Stats m_queueStats;
+    CullingStats m_cullingStats[3];
+    ShadowCacheStats m_shadowCacheStats; // sum over the measured frames
+    AnimationLod::Stats m_animationLodStats; // sum over the measured frames
+};
+
+#endif //ALGINE_EXAMPLES_BENCHMARK_H
@@ -0,0 +1,326 @@
+#include "BlendTree.h"
+
+#include <glm/matrix.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+BlendTree::Node BlendTree::addClip(uint clip) {
+    NodeData node;
+    node.type = Type::Clip;
+    node.clip = clip;
+
+    m_nodes.emplace_back(node);
+
+    return static_cast<Node>(m_nodes.size() - 1);
+}
+
+BlendTree::Node BlendTree::addBlend(const vector<Node> &inputs, const vector<float> &weights) {
+    if (inputs.empty() || (!weights.empty() && weights.size() != inputs.size())) {
+        cerr << "BlendTree: blend must have inputs and a weight for each of them\n";
+        return None;
+    }
+
+    NodeData node;
+    node.type = Type::Blend;
+    node.inputs = inputs;
+    node.weights = weights.empty() ? vector<float>(inputs.size(), 1.0f) : weights;
+
+    m_nodes.emplace_back(node);
+
+    return static_cast<Node>(m_nodes.size() - 1);
+}
+
+BlendTree::Node BlendTree::addLayer(Node base, Node layer, LayerMode mode, float weight,
+                                    const vector<float> &mask, Node reference)
+{
+    NodeData node;
+    node.type = Type::Layer;
+    node.inputs = {base, layer, reference};
+    node.weights = {weight};
+    node.mode = mode;
+    node.mask = mask;
+
+    m_nodes.emplace_back(node);
+
+    return static_cast<Node>(m_nodes.size() - 1);
+}
+
+void BlendTree::setWeight(Node blend, uint input, float weight) {
+    auto node = getNode(blend, Type::Blend);
+
+    if (!node)
+        return;
+
+    if (input >= node->weights.size()) {
+        cerr << "BlendTree: blend " << blend << " has no input " << input << "\n";
+        return;
+    }
+
+    setNodeWeight(*node, input, weight);
+}
+
+void BlendTree::setWeights(Node blend, const vector<float> &weights) {
+    auto node = getNode(blend, Type::Blend);
+
+    if (!node)
+        return;
+
+    if (weights.size() != node->weights.size()) {
+        cerr << "BlendTree: blend " << blend << " must have a weight for each input\n";
+        return;
+    }
+
+    for (uint i = 0; i < weights.size(); i++) {
+        setNodeWeight(*node, i, weights[i]);
+    }
+}
+
+void BlendTree::setLayerWeight(Node layer, float weight) {
+    if (auto node = getNode(layer, Type::Layer)) {
+        setNodeWeight(*node, 0, weight);
+    }
+}
+
+BlendTree::NodeData* BlendTree::getNode(Node index, Type type) {
+    if (index >= m_nodes.size() || m_nodes[index].type != type) {
+        cerr << "BlendTree: node " << index << " is not a " << (type == Type::Blend ? "blend" : "layer") << "\n";
+        return nullptr;
+    }
+
+    return &m_nodes[index];
+}
+
+void BlendTree::setNodeWeight(NodeData &node, uint input, float weight) {
+    if (node.weights[input] != weight) {
+        node.weights[input] = weight;
+        node.dirty = true;
+    }
+}
+
+void BlendTree::setRoot(Node root) {
+    m_root = root;
+}
+
+void BlendTree::invalidateClips() {
+    for (auto &node : m_nodes) {
+        if (node.type == Type::Clip) {
+            node.dirty = true;
+        }
+    }
+}
+
+bool BlendTree::evaluate(const Sampler &sample) {
+    m_stats = {};
+
+    if (m_root == None)
+        return false;
+
+    ++m_frame;
+
+    auto output = evaluate(m_root, sample);
+
+    for (auto &node : m_nodes) {
+        if (node.frame != m_frame) {
+            release(node);
+        }
+    }
+
+    bool changed = output.version != m_output.version;
+    m_output = output;
+
+    return changed;
+}
+
+const BlendTree::Pose& BlendTree::getPose() const {
+    static const Pose empty;
+    return m_output.pose ? *m_output.pose : empty;
+}
+
+const BlendTree::Stats& BlendTree::getStats() const {
+    return m_stats;
+}
+
+uint BlendTree::getPoolSize() const {
+    return static_cast<uint>(m_pool.size());
+}
+
+BlendTree::Output BlendTree::evaluate(Node index, const Sampler &sample) {
+    auto &node = m_nodes[index];
+    node.frame = m_frame;
+
+    switch (node.type) {
+        case Type::Blend: return evaluateBlend(node, sample);
+        case Type::Layer: return evaluateLayer(node, sample);
+        default: break;
+    }
+
+    if (node.dirty || node.buffer < 0) {
+        sample(node.clip, acquire(node));
+        node.version = ++m_version;
+        node.dirty = false;
+        ++m_stats.sampled;
+    } else {
+        ++m_stats.skipped;
+    }
+
+    return {&m_pool[node.buffer], node.version};
+}
+
+BlendTree::Output BlendTree::evaluateBlend(NodeData &node, const Sampler &sample) {
+    vector<Output> inputs;
+    vector<float> weights;
+    vector<uint64_t> versions;
+    float total = 0.0f;
+
+    // inputs without weight are not evaluated at all
+    for (uint i = 0; i < node.inputs.size(); i++) {
+        if (node.weights[i] <= 0.0f)
+            continue;
+
+        auto input = evaluate(node.inputs[i], sample);
+        inputs.emplace_back(input);
+        weights.emplace_back(node.weights[i]);
+        versions.emplace_back(input.version);
+        total += node.weights[i];
+    }
+
+    if (inputs.empty())
+        inputs.emplace_back(evaluate(node.inputs[0], sample));
+
+    if (inputs.size() == 1) {
+        release(node);
+        ++m_stats.skipped;
+        return inputs[0];
+    }
+
+    if (isCached(node, versions)) {
+        ++m_stats.skipped;
+        return {&m_pool[node.buffer], node.version};
+    }
+
+    size_t bonesCount = inputs[0].pose->size();
+
+    for (auto &input : inputs)
+        bonesCount = min(bonesCount, input.pose->size());
+
+    auto &pose = acquire(node);
+    pose.resize(bonesCount);
+
+    for (size_t b = 0; b < bonesCount; b++) {
+        glm::mat4 bone = (*inputs[0].pose)[b] * (weights[0] / total);
+
+        for (size_t i = 1; i < inputs.size(); i++)
+            bone += (*inputs[i].pose)[b] * (weights[i] / total);
+
+        pose[b] = bone;
+    }
+
+    node.version = ++m_version;
+    ++m_stats.blended;
+
+    return {&pose, node.version};
+}
+
+BlendTree::Output BlendTree::evaluateLayer(NodeData &node, const Sampler &sample) {
+    auto base = evaluate(node.inputs[0], sample);
+    float weight = node.weights[0];
+
+    if (weight <= 0.0f) {
+        release(node);
+        ++m_stats.skipped;
+        return base;
+    }
+
+    auto layer = evaluate(node.inputs[1], sample);
+
+    bool additive = node.mode == LayerMode::Additive;
+    Output reference {nullptr, 0};
+
+    if (additive && node.inputs[2] != None)
+        reference = evaluate(node.inputs[2], sample);
+
+    if (isCached(node, {base.version, layer.version, reference.version})) {
+        ++m_stats.skipped;
+        return {&m_pool[node.buffer], node.version};
+    }
+
+    auto &basePose = *base.pose;
+    auto &layerPose = *layer.pose;
+    auto bonesCount = min(basePose.size(), layerPose.size());
+
+    if (reference.pose && node.referenceVersion != reference.version) {
+        node.inverseReference.resize(reference.pose->size());
+
+        for (size_t b = 0; b < reference.pose->size(); b++)
+            node.inverseReference[b] = glm::inverse((*reference.pose)[b]);
+
+        node.referenceVersion = reference.version;
+    }
+
+    auto &pose = acquire(node);
+    pose = basePose;
+
+    const glm::mat4 identity(1.0f);
+
+    for (size_t b = 0; b < bonesCount; b++) {
+        float w = weight;
+
+        if (!node.mask.empty())
+            w *= b < node.mask.size() ? node.mask[b] : 0.0f;
+
+        if (w <= 0.0f)
+            continue;
+
+        if (additive) {
+            glm::mat4 delta = layerPose[b];
+
+            if (reference.pose && b < node.inverseReference.size())
+                delta = delta * node.inverseReference[b];
+
+            pose[b] = (identity + (delta - identity) * w) * basePose[b];
+        } else {
+            pose[b] = basePose[b] + (layerPose[b] - basePose[b]) * w;
+        }
+    }
+
+    node.version = ++m_version;
+    ++m_stats.blended;
+
+    return {&pose, node.version};
+}
+
+bool BlendTree::isCached(NodeData &node, const vector<uint64_t> &inputVersions) {
+    if (!node.dirty && node.buffer >= 0 && node.inputVersions == inputVersions)
+        return true;
+
+    node.inputVersions = inputVersions;
+    node.dirty = false;
+
+    return false;
+}
+
+BlendTree::Pose& BlendTree::acquire(NodeData &node) {
+    if (node.buffer < 0) {
+        if (m_free.empty()) {
+            m_pool.emplace_back();
+            node.buffer = static_cast<int>(m_pool.size() - 1);
+        } else {
+            node.buffer = m_free.back();
+            m_free.pop_back();
+        }
+    }
+
+    return m_pool[node.buffer];
+}
+
+void BlendTree::release(NodeData &node) {
+    if (node.buffer < 0)
+        return;
+
+    m_free.emplace_back(node.buffer);
+    node.buffer = -1;
+    node.inputVersions.clear();
+}
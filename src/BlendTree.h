@@ -0,0 +1,145 @@
+#ifndef ALGINE_EXAMPLES_BLENDTREE_H
+#define ALGINE_EXAMPLES_BLENDTREE_H
+
+#include <algine/types.h>
+
+#include <glm/mat4x4.hpp>
+
+#include <functional>
+#include <vector>
+#include <deque>
+#include <cstdint>
+
+using namespace algine;
+
+/**
+ * Blend tree over the bone matrices of the animation clips.
+ * Nodes are clips (sampled on demand), N-way blends and layers
+ * (override or additive, optionally masked per bone).
+ * Only clips reachable through non-zero weights are sampled, nodes
+ * whose inputs and params haven't changed keep their cached poses, and nodes
+ * with a single active input pass it through. Poses of the computed nodes
+ * are taken from a pool, nodes which are not reached return them
+ */
+class BlendTree {
+public:
+    using Pose = std::vector<glm::mat4>;
+    using Node = uint;
+
+    /**
+     * Writes the bones of the clip at the current time to <code>pose</code>
+     */
+    using Sampler = std::function<void(uint clip, Pose &pose)>;
+
+    enum class LayerMode {
+        Override, // lerp(base, layer, weight)
+        Additive // lerp(identity, layer * inverse(reference), weight) * base
+    };
+
+    struct Stats {
+        uint sampled = 0;
+        uint blended = 0;
+        uint skipped = 0; // cached or passed through
+    };
+
+    static constexpr Node None = ~0u;
+
+public:
+    Node addClip(uint clip);
+
+    /**
+     * @param weights are normalized by their sum; equal if empty
+     */
+    Node addBlend(const std::vector<Node> &inputs, const std::vector<float> &weights = {});
+
+    /**
+     * @param mask per bone weight multipliers, all bones if empty
+     * @param reference pose which the additive layer is relative to, e.g. the first frame of its clip
+     */
+    Node addLayer(Node base, Node layer, LayerMode mode, float weight = 1.0f,
+                  const std::vector<float> &mask = {}, Node reference = None);
+
+    void setWeight(Node blend, uint input, float weight);
+    void setWeights(Node blend, const std::vector<float> &weights);
+    void setLayerWeight(Node layer, float weight);
+
+    void setRoot(Node root);
+
+    /**
+     * Marks the clips to be sampled again, e.g. when the time changes
+     */
+    void invalidateClips();
+
+    /**
+     * @return true if the pose has changed
+     */
+    bool evaluate(const Sampler &sample);
+
+    const Pose& getPose() const;
+    const Stats& getStats() const;
+
+    /**
+     * @return count of the pose buffers, including the free ones
+     */
+    uint getPoolSize() const;
+
+private:
+    enum class Type {
+        Clip,
+        Blend,
+        Layer
+    };
+
+    struct NodeData {
+        Type type;
+        uint clip = 0;
+        std::vector<Node> inputs; // layers: base, layer, reference
+        std::vector<float> weights;
+        LayerMode mode = LayerMode::Override;
+        std::vector<float> mask;
+
+        bool dirty = true;
+        int buffer = -1;
+        uint64_t version = 0; // of the node output, unique within the tree
+        std::vector<uint64_t> inputVersions; // of the computed output
+        uint64_t frame = 0; // last evaluation which reached the node
+
+        uint64_t referenceVersion = 0;
+        Pose inverseReference;
+    };
+
+    struct Output {
+        const Pose *pose;
+        uint64_t version;
+    };
+
+    /**
+     * @return nullptr if the node doesn't exist or has another type
+     */
+    NodeData* getNode(Node index, Type type);
+    static void setNodeWeight(NodeData &node, uint input, float weight);
+
+    Output evaluate(Node index, const Sampler &sample);
+    Output evaluateBlend(NodeData &node, const Sampler &sample);
+    Output evaluateLayer(NodeData &node, const Sampler &sample);
+
+    /**
+     * @return true if the node's cached output is still valid for the inputs
+     */
+    bool isCached(NodeData &node, const std::vector<uint64_t> &inputVersions);
+
+    Pose& acquire(NodeData &node);
+    void release(NodeData &node);
+
+private:
+    std::vector<NodeData> m_nodes;
+    Node m_root = None;
+    std::deque<Pose> m_pool; // deque - references stay valid while it grows
+    std::vector<int> m_free;
+    Output m_output {nullptr, 0};
+    uint64_t m_version = 0;
+    uint64_t m_frame = 0;
+    Stats m_stats;
+};
+
+#endif //ALGINE_EXAMPLES_BLENDTREE_H
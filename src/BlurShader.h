@@ -0,0 +1,19 @@
+#ifndef BLURSHADER_H
+#define BLURSHADER_H
+
+#define constant(name, val) constexpr char name[] = val;
+
+namespace BlurShader::Vars {
+constant(Image, "image")
+constant(Direction, "direction")
+constant(TapsCount, "tapsCount")
+constant(Offsets, "offsets")
+constant(Weights, "weights")
+constant(Radius, "radius")
+constant(HalfPixel, "halfPixel")
+constant(Upsample, "upsample")
+}
+
+#undef constant
+
+#endif //BLURSHADER_H
@@ -0,0 +1,171 @@
+#include "Bounds.h"
+
+#include <algine/std/model/Shape.h>
+#include <algine/gl.h>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <cfloat>
+#include <cstring>
+#include <cmath>
+
+using namespace std;
+
+AABB AABB::transform(const glm::mat4 &matrix) const {
+    // Arvo's method: transformed center + extents projected on the new axes
+    glm::vec3 center = (min + max) * 0.5f;
+    glm::vec3 extents = (max - min) * 0.5f;
+
+    glm::vec3 newCenter = glm::vec3(matrix * glm::vec4(center, 1.0f));
+    glm::vec3 newExtents {0.0f};
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            newExtents[i] += glm::abs(matrix[j][i]) * extents[j];
+        }
+    }
+
+    return {newCenter - newExtents, newCenter + newExtents};
+}
+
+void AABB::extend(const AABB &other) {
+    min = glm::min(min, other.min);
+    max = glm::max(max, other.max);
+}
+
+bool Sphere::intersects(const AABB &box) const {
+    glm::vec3 closest = glm::clamp(center, box.min, box.max);
+    glm::vec3 d = closest - center;
+
+    return glm::dot(d, d) <= radius * radius;
+}
+
+Frustum::Frustum(const glm::mat4 &matrix) {
+    // Gribb & Hartmann
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 2; j++) {
+            float sign = j == 0 ? 1.0f : -1.0f;
+
+            glm::vec4 plane;
+
+            for (int k = 0; k < 4; k++)
+                plane[k] = matrix[k][3] + sign * matrix[k][i];
+
+            m_planes[i * 2 + j] = plane / glm::length(glm::vec3(plane));
+        }
+    }
+}
+
+bool Frustum::intersects(const AABB &box) const {
+    for (auto &plane : m_planes) {
+        // the most positive vertex along the plane normal
+        glm::vec3 p {
+            plane.x >= 0 ? box.max.x : box.min.x,
+            plane.y >= 0 ? box.max.y : box.min.y,
+            plane.z >= 0 ? box.max.z : box.min.z
+        };
+
+        if (glm::dot(glm::vec3(plane), p) + plane.w < 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+ShapeBounds computeShapeBounds(const ShapePtr &shape, uint layoutIndex, uint positionLocation, float skinnedScale) {
+    shape->getInputLayout(layoutIndex)->bind();
+
+    GLint vertexBuffer, indexBuffer, components, stride;
+    void *pointer;
+
+    glGetVertexAttribiv(positionLocation, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &vertexBuffer);
+    glGetVertexAttribiv(positionLocation, GL_VERTEX_ATTRIB_ARRAY_SIZE, &components);
+    glGetVertexAttribiv(positionLocation, GL_VERTEX_ATTRIB_ARRAY_STRIDE, &stride);
+    glGetVertexAttribPointerv(positionLocation, GL_VERTEX_ATTRIB_ARRAY_POINTER, &pointer);
+    glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &indexBuffer);
+
+    auto offset = reinterpret_cast<uintptr_t>(pointer);
+
+    if (stride == 0)
+        stride = components * static_cast<GLint>(sizeof(float));
+
+    auto readBuffer = [](GLint buffer) {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+
+        GLint size;
+        glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &size);
+
+        vector<uint8_t> data(size);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, 0, size, data.data());
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+        return data;
+    };
+
+    auto vertices = readBuffer(vertexBuffer);
+    auto indicesData = readBuffer(indexBuffer);
+
+    auto indices = reinterpret_cast<const uint*>(indicesData.data());
+    auto indicesCount = indicesData.size() / sizeof(uint);
+
+    ShapeBounds result;
+    result.bounds = {glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX)};
+
+    for (auto &mesh : shape->getMeshes()) {
+        AABB box {glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX)};
+
+        for (uint i = mesh.start; i < mesh.start + mesh.count && i < indicesCount; i++) {
+            glm::vec3 pos;
+            memcpy(&pos, &vertices[offset + indices[i] * stride], sizeof(glm::vec3));
+
+            box.min = glm::min(box.min, pos);
+            box.max = glm::max(box.max, pos);
+        }
+
+        if (shape->isBonesPresent()) {
+            glm::vec3 center = (box.min + box.max) * 0.5f;
+            glm::vec3 extents = (box.max - box.min) * 0.5f * skinnedScale;
+            box = {center - extents, center + extents};
+        }
+
+        result.bounds.extend(box);
+        result.meshes.emplace_back(box);
+    }
+
+    return result;
+}
+
+glm::mat4 getCubeFaceMatrix(const glm::vec3 &pos, uint face, float far, float near) {
+    static const glm::vec3 directions[6] = {
+        {1.0f, 0.0f, 0.0f}, {-1.0f, 0.0f, 0.0f},
+        {0.0f, 1.0f, 0.0f}, {0.0f, -1.0f, 0.0f},
+        {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f}
+    };
+
+    static const glm::vec3 ups[6] = {
+        {0.0f, -1.0f, 0.0f}, {0.0f, -1.0f, 0.0f},
+        {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f},
+        {0.0f, -1.0f, 0.0f}, {0.0f, -1.0f, 0.0f}
+    };
+
+    glm::mat4 projection = glm::perspective(glm::half_pi<float>(), 1.0f, near, far);
+
+    return projection * glm::lookAt(pos, pos + directions[face], ups[face]);
+}
+
+float getLightRadius(float kc, float kl, float kq, float threshold) {
+    // 1 / (kc + kl * d + kq * d^2) = threshold
+    float c = kc - 1.0f / threshold;
+
+    if (kq > 0.0f)
+        return (-kl + sqrt(kl * kl - 4.0f * kq * c)) / (2.0f * kq);
+
+    if (kl > 0.0f)
+        return -c / kl;
+
+    return FLT_MAX;
+}
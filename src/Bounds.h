@@ -0,0 +1,75 @@
+#ifndef ALGINE_EXAMPLES_BOUNDS_H
+#define ALGINE_EXAMPLES_BOUNDS_H
+
+#include <algine/std/model/ShapePtr.h>
+#include <algine/types.h>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+#include <vector>
+
+using namespace algine;
+
+struct AABB {
+    glm::vec3 min {0.0f};
+    glm::vec3 max {0.0f};
+
+    AABB transform(const glm::mat4 &matrix) const;
+    void extend(const AABB &other);
+};
+
+struct Sphere {
+    glm::vec3 center {0.0f};
+    float radius = 0.0f;
+
+    bool intersects(const AABB &box) const;
+};
+
+/**
+ * Planes extracted from the projection * view matrix.
+ * Works for both perspective and orthographic projections
+ */
+class Frustum {
+public:
+    explicit Frustum(const glm::mat4 &matrix);
+
+    bool intersects(const AABB &box) const;
+
+private:
+    glm::vec4 m_planes[6];
+};
+
+struct ShapeBounds {
+    AABB bounds;
+    std::vector<AABB> meshes;
+};
+
+struct CullingStats {
+    uint drawn = 0;
+    uint culled = 0;
+};
+
+/**
+ * Computes bounding boxes of the shape and its meshes. Positions and indices
+ * are read back from the buffers of the input layout, so it must be called
+ * once, right after the shape is created.
+ * Bounding boxes of the skinned shapes are computed in the bind pose,
+ * so they are enlarged by <code>skinnedScale</code>
+ * @param positionLocation location of the position attribute in the input layout
+ */
+ShapeBounds computeShapeBounds(const ShapePtr &shape, uint layoutIndex, uint positionLocation, float skinnedScale = 1.5f);
+
+/**
+ * @return projection * view matrix of the cube map face
+ * <code>face</code> (in the GL_TEXTURE_CUBE_MAP_POSITIVE_X + face order) seen from <code>pos</code>
+ */
+glm::mat4 getCubeFaceMatrix(const glm::vec3 &pos, uint face, float far, float near = 0.01f);
+
+/**
+ * @return distance at which attenuation falls below <code>threshold</code>
+ */
+float getLightRadius(float kc, float kl, float kq, float threshold = 5.0f / 256.0f);
+
+#endif //ALGINE_EXAMPLES_BOUNDS_H
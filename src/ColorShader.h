@@ -5,9 +5,6 @@
 
 namespace ColorShader::Vars {
 constant(ModelMatrix, "modelMatrix")
-constant(ViewMatrix, "viewMatrix")
-constant(MVPMatrix, "MVPMatrix")
-constant(MVMatrix, "MVMatrix")
 constant(InPos, "inPos")
 constant(InNormal, "inNormal")
 constant(InTexCoord, "inTexCoord")
@@ -3,22 +3,32 @@
 #include "constants.h" // TODO move dof
 #include "BlendShader.h"
 #include "ColorShader.h"
+#include "PointShadowShader.h"
+#include "SSRShader.h"
+#include "SkinningShader.h"
+#include "ProgramBatch.h"
+#include "GLExtensions.h"
 
 #include <algine/core/Engine.h>
 #include <algine/core/window/Window.h>
 #include <algine/core/shader/ShaderCreator.h>
-#include <algine/core/shader/ShaderProgramCreator.h>
-#include <algine/core/texture/TextureCubeCreator.h>
+#include <algine/core/shader/ShaderProgram.h>
+#include <algine/core/texture/TextureCube.h>
 #include <algine/core/PtrMaker.h>
 
 #include <algine/std/model/Shape.h>
 #include <algine/std/model/Model.h>
-#include <algine/std/model/ModelCreator.h>
 #include <algine/std/CubeRenderer.h>
 
 #include <algine/constants/CubemapShader.h>
 #include <algine/constants/ShadowShader.h>
 
+#include <algine/gl.h>
+
+#include <glm/common.hpp>
+#include <glm/matrix.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
 #include <iostream>
 #include <cfloat>
 
@@ -40,17 +50,31 @@ constant diskRadius_min = 0.0f;
 // shadow opacity: 1.0 - opaque shadow (by default), 0.0 - transparent
 constant shadowOpacity = 0.65f;
 
+// SSR is not traced for the pixels with lower reflection strength
+constant ssrMinReflectionStrength = 0.01f;
+
+// smaller blurs don't gain from the downsample chain
+constant kawaseMinRadius = 8u;
+
+// time per frame for uploading of the streamed assets, in ms
+constant assetsUploadBudget = 2.0f;
+
 ExampleChessContent::~ExampleChessContent() {
     lampThread.stopLoop();
 }
 
 void ExampleChessContent::init() {
+    // skybox faces are decoded by the workers while shaders are compiled and models are loaded
+    auto skyboxFuture = assetLoader.loadTextureCube(resources "textures/skybox/Skybox.conf.json");
+
     initShaders();
+    InstancedModelGroup::resetInstanceMatrix();
     initCamera();
     createModels();
     initLamps();
     initShadowMaps();
     initDOF();
+    initAnimationJobs();
 
     Engine::enableDepthTest();
     Engine::enableDepthMask();
@@ -58,53 +82,108 @@ void ExampleChessContent::init() {
 
     getWindow()->setEventHandler(this);
 
-    lampThread.content = this;
-    lampThread.startLoop();
+    skybox = assetLoader.wait(skyboxFuture);
+
+    auto progress = assetLoader.getProgress();
+    cout << "Loaded " << progress.loaded << " of " << progress.total << " assets\n";
+
+    // the loop is started by the first frame without the time override,
+    // so the benchmark playback doesn't depend on how long the loading took
+    lampThread.setTickRate(simulationTickRate);
+    lampThread.setPos(pointLamps[0].m_pos);
 }
 
 void ExampleChessContent::render() {
+    profiler.beginFrame();
+
+    if (targetPool.update())
+        resize();
+
     pollKeys();
+    updateSimulation();
+
+    profiler.beginZone("assetsUpload");
+    assetLoader.update(assetsUploadBudget);
+    profiler.endZone();
 
     // animate
-    for (auto &model : models) {
-        if (model->getShape()->isBonesPresent()) {
-            auto animationsAmount = model->getShape()->getAnimationsAmount();
-            auto animator = model->getAnimator();
+    profiler.beginZone("animation");
+    profiler.beginZone("animate");
 
-            for (uint j = 0; j < animationsAmount; j++) {
-                animator->setAnimationIndex(j);
-                animator->animate((float)(Engine::timeFromStart()) / 1000.0f);
-            }
-        }
+    if (auto time = getTime(); time != animationTime) {
+        animationTime = time;
+        ++bonesVersion;
     }
 
-    manAnimationBlender.blend();
+    animationLod.update(animationTime, camera.getViewMatrix(), camera.getProjectionMatrix());
+
+    animationJobs.run(jobSystem);
 
+    profiler.endZone();
+
+    profiler.beginZone("bonesUpload");
     boneManager.getBlockBufferStorage().bind();
     boneManager.writeBonesForAll();
     Engine::defaultUniformBuffer()->bind();
+    profiler.endZone();
+
+    // skinned vertices are reused by all passes, until the bones change
+    if (preSkinning.isEnabled() && preSkinnedBonesVersion != bonesVersion) {
+        profiler.beginZone("preSkinning");
+        preSkinning.update([this](ModelPtr &model) { boneManager.linkBuffer(model); });
+        preSkinnedBonesVersion = bonesVersion;
+        profiler.endZone();
+    }
+
+    profiler.endZone();
+
+    colorCulling = {};
+    pointShadowCulling = {};
+    dirShadowCulling = {};
+    shadowCacheStats = {};
 
     // shadow rendering
+    // shadow maps of the unchanged lights are kept from the previous frames
     // point lights
+    beginPass(PassTimer::ShadowCubemap);
     pointShadowShader->bind();
 
     for (uint i = 0; i < pointLamps.size(); i++) {
+        if (!isPointShadowDirty(i)) {
+            ++shadowCacheStats.skipped;
+            continue;
+        }
+
         lightManager.pushShadowShaderFarPlane(pointLamps[i]);
         renderToDepthCubemap(i);
+        ++shadowCacheStats.rendered;
     }
 
+    endPass(PassTimer::ShadowCubemap);
+
     // dir lights
+    beginPass(PassTimer::DirShadow);
     dirShadowShader->bind();
 
-    for (uint i = 0; i < dirLamps.size(); i++)
+    for (uint i = 0; i < dirLamps.size(); i++) {
+        if (!isDirShadowDirty(i)) {
+            ++shadowCacheStats.skipped;
+            continue;
+        }
+
         renderToDepthMap(i);
+        ++shadowCacheStats.rendered;
+    }
 
-    ssrShader->bind();
-    ssrShader->setMat4("projection", camera.getProjectionMatrix());
-    ssrShader->setMat4("view", camera.getViewMatrix());
+    endPass(PassTimer::DirShadow);
+
+    frameUniforms.update(camera.getViewMatrix(), camera.getProjectionMatrix(),
+                         targetPool.getWidth(), targetPool.getHeight(), getTime());
 
     /* --- color rendering --- */
     renderScene();
+
+    profiler.endFrame();
 }
 
 void ExampleChessContent::mouseMove(double x, double y, Window &window) {
@@ -124,9 +203,29 @@ void ExampleChessContent::mouseClick(MouseKey key, Window &window) {
         return;
 
     float pixel[3];
+    uint x = targetPool.getWidth() / 2;
+    uint y = targetPool.getHeight() / 2;
 
     displayFb->bind();
-    displayFb->readPixels(Framebuffer::ColorAttachmentZero + 2, width() / 2, height() / 2, 1, 1, Texture::RGB, DataType::Float, pixel);
+
+    if (compactGBuffer) {
+        // the same as getViewPosition in GBuffer.glsl
+        float depth;
+        glReadPixels(x, y, 1, 1, GL_DEPTH_COMPONENT, GL_FLOAT, &depth);
+
+        glm::vec4 pos(0.0f);
+
+        if (depth < 1.0f) {
+            pos = glm::inverse(camera.getProjectionMatrix()) * glm::vec4(0.0f, 0.0f, depth * 2.0f - 1.0f, 1.0f);
+            pos /= pos.w;
+        }
+
+        pixel[0] = pos.x;
+        pixel[1] = pos.y;
+        pixel[2] = pos.z;
+    } else {
+        displayFb->readPixels(Framebuffer::ColorAttachmentZero + 2, x, y, 1, 1, Texture::RGB, DataType::Float, pixel);
+    }
 
     cout << "Position map: x: " << pixel[0] << "; y: " << pixel[1] << "; z: " << pixel[2] << "\n";
 
@@ -137,25 +236,153 @@ void ExampleChessContent::mouseClick(MouseKey key, Window &window) {
 void ExampleChessContent::keyboardKeyPress(KeyboardKey key, Window &window) {
     if (key == KeyboardKey::F) {
         getWindow()->setFullscreen(!getWindow()->isFullscreen());
+    } else if (key == KeyboardKey::P) {
+        profiler.setEnabled(!profiler.isEnabled());
+        cout << "Profiler " << (profiler.isEnabled() ? "enabled" : "disabled") << "\n";
+    } else if (key == KeyboardKey::T) {
+        if (profiler.dumpChromeTrace("trace.json")) {
+            cout << "Profiler: " << profiler.getFramesCount() << " frames written to trace.json\n";
+        }
     }
 }
 
+// the render size follows in the next frames, see RenderTargetPool
 void ExampleChessContent::windowSizeChange(int, int, Window&) {
-    resize();
+    targetPool.setWindowSize(width(), height());
 
     camera.setAspectRatio((float) width() / height());
     camera.perspective();
 }
 
+void ExampleChessContent::setPassTimer(PassTimer *timer) {
+    passTimer = timer;
+}
+
+void ExampleChessContent::setTimeOverride(float seconds) {
+    // the playback starts from the initial state, not from the ticks executed in real time
+    if (timeOverride < 0.0f && seconds >= 0.0f) {
+        lampThread.stopLoop();
+        lampThread.seek(0);
+    }
+
+    timeOverride = seconds;
+}
+
+void ExampleChessContent::setPointShadowMode(PointShadowMode mode) {
+    pointShadowMode = mode;
+}
+
+ExampleChessContent::PointShadowMode ExampleChessContent::getPointShadowMode() const {
+    return pointShadowMode;
+}
+
+void ExampleChessContent::setPreSkinningEnabled(bool enabled) {
+    preSkinningEnabled = enabled;
+}
+
+bool ExampleChessContent::isPreSkinningEnabled() const {
+    return preSkinningEnabled;
+}
+
+void ExampleChessContent::setCompactGBufferEnabled(bool enabled) {
+    compactGBuffer = enabled;
+}
+
+bool ExampleChessContent::isCompactGBufferEnabled() const {
+    return compactGBuffer;
+}
+
+void ExampleChessContent::setSSRMode(SSRMode mode) {
+    ssrMode = mode;
+}
+
+ExampleChessContent::SSRMode ExampleChessContent::getSSRMode() const {
+    return ssrMode;
+}
+
+void ExampleChessContent::setBlurMode(GaussianBlur::Mode mode) {
+    blurMode = mode;
+}
+
+GaussianBlur::Mode ExampleChessContent::getBlurMode() const {
+    return blurMode;
+}
+
+float ExampleChessContent::getBlurFetchesPerPixel() const {
+    float bloomArea = bloomK * bloomK;
+    float dofArea = dofK * dofK;
+
+    return bloomBlur->getFetchesPerPixel() * bloomArea +
+           (cocBlur->getFetchesPerPixel() + dofBlur->getFetchesPerPixel()) * dofArea;
+}
+
+const char* ExampleChessContent::getSSRModeName(SSRMode mode) {
+    switch (mode) {
+        case SSRMode::HiZ: return "hiz";
+        case SSRMode::HiZHalf: return "hiz-half";
+        default: return "linear";
+    }
+}
+
+const char* ExampleChessContent::getPointShadowModeName(PointShadowMode mode) {
+    switch (mode) {
+        case PointShadowMode::GeometryShader: return "gs";
+        case PointShadowMode::Instanced: return "instanced";
+        default: return "faces";
+    }
+}
+
+Camera& ExampleChessContent::getCamera() {
+    return camera;
+}
+
+Profiler& ExampleChessContent::getProfiler() {
+    return profiler;
+}
+
+const RenderQueue& ExampleChessContent::getRenderQueue() const {
+    return renderQueue;
+}
+
+const CullingStats& ExampleChessContent::getCullingStats(CullingPass pass) const {
+    switch (pass) {
+        case CullingPass::Color: return colorCulling;
+        case CullingPass::PointShadow: return pointShadowCulling;
+        default: return dirShadowCulling;
+    }
+}
+
+const ShadowCacheStats& ExampleChessContent::getShadowCacheStats() const {
+    return shadowCacheStats;
+}
+
+const AnimationLod::Stats& ExampleChessContent::getAnimationLodStats() const {
+    return animationLod.getStats();
+}
+
+const RenderTargetPool::Stats& ExampleChessContent::getRenderTargetStats() const {
+    return targetPool.getStats();
+}
+
+// post-processing targets are resized by the pool
 void ExampleChessContent::resize() {
-    displayFb->resizeAttachments(width(), height());
-    screenspaceFb->resizeAttachments(width(), height()); // TODO: make small sst + blend pass in the future
-    bloomSearchFb->resizeAttachments(width() * bloomK, height() * bloomK);
-    cocFb->resizeAttachments(width() * dofK, height() * dofK);
+    uint renderWidth = targetPool.getWidth();
+    uint renderHeight = targetPool.getHeight();
+
+    displayFb->resizeAttachments(renderWidth, renderHeight);
+
+    if (ssrMode != SSRMode::Linear) {
+        hiZ.resize(renderWidth, renderHeight);
+
+        ssrShader->bind();
+        ssrShader->setInt(SSRShader::Vars::HiZLevels, static_cast<int>(hiZ.getLevelsCount()));
+        ssrShader->unbind();
+    }
 
-    bloomBlur->resizeOutput(width() * bloomK, height() * bloomK);
-    cocBlur->resizeOutput(width() * dofK, height() * dofK);
-    dofBlur->resizeOutput(width() * dofK, height() * dofK);
+    // PingPong blurs only, the others are in the pool
+    bloomBlur->resizeOutput(renderWidth * bloomK, renderHeight * bloomK);
+    cocBlur->resizeOutput(renderWidth * dofK, renderHeight * dofK);
+    dofBlur->resizeOutput(renderWidth * dofK, renderHeight * dofK);
 }
 
 void ExampleChessContent::pollKeys() {
@@ -187,6 +414,9 @@ void ExampleChessContent::pollKeys() {
         manHeadRotator.rotate(r);
 
         models[1]->setBoneTransform("Head", r);
+
+        animationLod.invalidate(models[1]);
+        ++bonesVersion;
     };
 
     if (isKeyPressed(KeyboardKey::Up))
@@ -202,9 +432,9 @@ void ExampleChessContent::pollKeys() {
         rotateManHead({0.0f, -glm::radians(5.0f), 0.0f});
 
     if (isKeyPressed(KeyboardKey::Key1)) {
-        manAnimationBlender.changeFactor(-0.025f);
+        setManBlendFactor(manBlendFactor - 0.025f);
     } else if (isKeyPressed(KeyboardKey::Key2)) {
-        manAnimationBlender.changeFactor(0.025f);
+        setManBlendFactor(manBlendFactor + 0.025f);
     }
 }
 
@@ -220,14 +450,15 @@ void ExampleChessContent::createPointLamp(PointLamp &result, const glm::vec3 &po
     result.updateMatrix();
     result.initShadows(shadowMapResolution, shadowMapResolution);
 
-    lightManager.bindBuffer();
-    lightManager.writeColor(result, id);
-    lightManager.writeKc(result, id);
-    lightManager.writeKl(result, id);
-    lightManager.writeKq(result, id);
-    lightManager.writeFarPlane(result, id);
-    lightManager.writeBias(result, id);
-    lightManager.unbindBuffer();
+    // written to the staging copy, uploaded by the flush in initLamps
+    auto name = "pointLights[" + to_string(id) + "].";
+    lightingBlock.setVec3(name + "pos", result.m_pos);
+    lightingBlock.setVec3(name + "color", result.getColor());
+    lightingBlock.setFloat(name + "kc", result.getKc());
+    lightingBlock.setFloat(name + "kl", result.getKl());
+    lightingBlock.setFloat(name + "kq", result.getKq());
+    lightingBlock.setFloat(name + "far", result.getFar());
+    lightingBlock.setFloat(name + "bias", result.getBias());
 }
 
 void ExampleChessContent::createDirLamp(DirLamp &result, const glm::vec3 &pos, const glm::vec3 &rotate,
@@ -247,61 +478,141 @@ void ExampleChessContent::createDirLamp(DirLamp &result, const glm::vec3 &pos, c
     result.updateMatrix();
     result.initShadows(shadowMapResolution, shadowMapResolution);
 
-    lightManager.bindBuffer();
-    lightManager.writeColor(result, id);
-    lightManager.writeKc(result, id);
-    lightManager.writeKl(result, id);
-    lightManager.writeKq(result, id);
-    lightManager.writeMinBias(result, id);
-    lightManager.writeMaxBias(result, id);
-    lightManager.writeLightMatrix(result, id);
-    lightManager.unbindBuffer();
+    auto name = "dirLights[" + to_string(id) + "].";
+    lightingBlock.setVec3(name + "pos", result.m_pos);
+    lightingBlock.setVec3(name + "color", result.getColor());
+    lightingBlock.setFloat(name + "kc", result.getKc());
+    lightingBlock.setFloat(name + "kl", result.getKl());
+    lightingBlock.setFloat(name + "kq", result.getKq());
+    lightingBlock.setFloat(name + "minBias", result.getMinBias());
+    lightingBlock.setFloat(name + "maxBias", result.getMaxBias());
+    lightingBlock.setMat4(name + "lightMatrix", result.getLightSpaceMatrix());
 }
 
 void ExampleChessContent::initShaders() {
     cout << "Compiling algine shaders\n";
 
-    ShaderCreator::setGlobalIncludePaths({
+    vector<string> includePaths {
         algineResources,
         resources "shaders"
-    });
+    };
+
+    ShaderCreator::setGlobalIncludePaths(includePaths);
+    programCache.setIncludePaths(includePaths);
 
-    auto programFromConfig = [](ShaderProgramPtr &program, const string &configName) {
-        ShaderProgramCreator creator;
-        creator.importFromFile(resources "programs/" + configName + ".conf.json");
-        program = creator.create();
-        program->loadActiveLocations();
+    // programs are compiled and linked in parallel, they are ready after finish()
+    ProgramBatch batch(jobSystem, &programCache);
+    batch.setIncludePaths(includePaths);
+
+    auto programFromConfig = [&batch](ShaderProgramPtr &program, const string &configName) {
+        batch.add(program, resources "programs/" + configName + ".conf.json");
     };
 
-    programFromConfig(colorShader, "Color");
-    programFromConfig(pointShadowShader, "PointShadow");
+    programFromConfig(colorShader, compactGBuffer ? "ColorCompact" : "Color");
+
+    if (pointShadowMode == PointShadowMode::Instanced &&
+        !isExtensionSupported("GL_ARB_shader_viewport_layer_array") &&
+        !isExtensionSupported("GL_AMD_vertex_shader_layer"))
+    {
+        cerr << "gl_Layer can't be written from the vertex shader, per-face point shadows will be used\n";
+        pointShadowMode = PointShadowMode::PerFace;
+    }
+
+    switch (pointShadowMode) {
+        case PointShadowMode::GeometryShader: programFromConfig(pointShadowShader, "PointShadow"); break;
+        case PointShadowMode::Instanced: programFromConfig(pointShadowShader, "PointShadowInstanced"); break;
+        case PointShadowMode::PerFace: programFromConfig(pointShadowShader, "PointShadowPerFace"); break;
+    }
+
     programFromConfig(dirShadowShader, "DirShadow");
-    programFromConfig(dofCoCShader, "DofCoc");
+    programFromConfig(dofCoCShader, compactGBuffer ? "DofCocCompact" : "DofCoc");
     programFromConfig(blendShader, "Blend");
     programFromConfig(skyboxShader, "Skybox");
-    programFromConfig(ssrShader, "SSR");
+    if (ssrMode == SSRMode::Linear) {
+        programFromConfig(ssrShader, compactGBuffer ? "SSRCompact" : "SSR");
+    } else {
+        programFromConfig(ssrShader, compactGBuffer ? "SSRHiZCompact" : "SSRHiZ");
+        programFromConfig(ssrResolveShader, "SSRResolve");
+        programFromConfig(hiZShader, "HiZBuild");
+    }
+
     programFromConfig(bloomSearchShader, "BloomSearch");
 
-    cout << "Compilation done\n";
+    if (blurMode == GaussianBlur::Mode::Compute &&
+        (!isExtensionSupported("GL_ARB_compute_shader") || !isExtensionSupported("GL_ARB_shader_image_load_store")))
+    {
+        cerr << "Compute shaders are not supported, linear blur will be used\n";
+        blurMode = GaussianBlur::Mode::Linear;
+    }
+
+    // small blurs use Linear in the DualKawase mode
+    if (blurMode == GaussianBlur::Mode::Linear || blurMode == GaussianBlur::Mode::DualKawase)
+        programFromConfig(blurPrograms.linear, "BlurLinear");
+
+    if (blurMode == GaussianBlur::Mode::DualKawase)
+        programFromConfig(blurPrograms.kawase, "BlurKawase");
+
+    if (blurMode == GaussianBlur::Mode::Compute)
+        programFromConfig(blurPrograms.compute, "BlurCompute");
+
+    if (preSkinningEnabled) {
+        batch.add(skinningShader, resources "programs/Skinning.conf.json", PreSkinning::getFeedbackVaryings());
+    }
+
+    batch.finish();
+
+    auto &batchStats = batch.getStats();
+
+    cout << "Compilation done, programs compiled: " << batchStats.compiled
+         << ", loaded from cache: " << batchStats.cached
+         << ", compiled by the engine: " << batchStats.fallback << "\n";
+
+    colorUniforms.setProgram(colorShader);
+    pointShadowUniforms.setProgram(pointShadowShader);
+    dirShadowUniforms.setProgram(dirShadowShader);
+
+    if (skinningShader && !preSkinning.init(skinningShader)) {
+        skinningShader = nullptr;
+        preSkinningEnabled = false;
+    }
+
+    frameUniforms.setBindingPoint(2);
+    frameUniforms.setShaderPrograms({colorShader, ssrShader, dofCoCShader});
+
+    if (ssrResolveShader)
+        frameUniforms.setShaderPrograms({ssrResolveShader});
+
+    frameUniforms.init();
+
+    renderQueue.setProgram(colorUniforms);
 
     skyboxRenderer = PtrMaker::make(skyboxShader->getLocation(CubemapShader::Vars::InPos));
     quadRenderer = PtrMaker::make(0); // inPosLocation in quad shader is 0
 
-    PtrMaker::create(
-        displayFb, screenspaceFb, bloomSearchFb, cocFb,
-        colorTex, normalTex, ssrValues, positionTex, screenspaceTex, bloomTex, cocTex
-    );
+    // post-processing targets are in the pool, see below
+    PtrMaker::create(displayFb, colorTex, normalTex, ssrValues, depthTex);
 
     ssrValues->setFormat(Texture::RG16F);
-    cocTex->setFormat(Texture::Red16F);
-
-    TextureCubeCreator skyboxCreator;
-    skyboxCreator.importFromFile(resources "textures/skybox/Skybox.conf.json");
-    skybox = skyboxCreator.create();
+    depthTex->setFormat(Texture::DepthComponent);
 
     Texture2D::setParamsMultiple(Texture2D::defaultParams(),
-            colorTex.get(), normalTex.get(), ssrValues.get(), positionTex.get(),
-            screenspaceTex.get(), bloomTex.get(), cocTex.get());
+            colorTex.get(), normalTex.get(), ssrValues.get());
+
+    // depth is read texel by texel
+    depthTex->bind();
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    depthTex->unbind();
+
+    if (compactGBuffer) {
+        // octahedral normals, unsigned normalized, see GBuffer.glsl
+        normalTex->setFormat(GL_RG16);
+    } else {
+        positionTex = PtrMaker::make();
+        positionTex->setParams(Texture2D::defaultParams());
+    }
 
     TextureCreateInfo createInfo;
     createInfo.format = Texture::RGB16F;
@@ -309,66 +620,116 @@ void ExampleChessContent::initShaders() {
     createInfo.height = height() * bloomK;
     createInfo.params = Texture2D::defaultParams();
 
-    bloomBlur = PtrMaker::make<Blur>(createInfo);
-    bloomBlur->setPingPongShaders(Blur::getPingPongShaders(bloomBlurKernelRadius, "rgb"));
+    auto getBlurMode = [this](uint radius) {
+        return blurMode == GaussianBlur::Mode::DualKawase && radius < kawaseMinRadius ? GaussianBlur::Mode::Linear : blurMode;
+    };
+
+    bloomBlur = PtrMaker::make<GaussianBlur>(getBlurMode(bloomBlurKernelRadius), createInfo);
+    bloomBlur->setPrograms(blurPrograms);
     bloomBlur->setQuadRenderer(quadRenderer);
-    bloomBlur->configureKernel(bloomBlurKernelRadius, bloomBlurKernelSigma);
+    bloomBlur->setTargetPool(&targetPool, "bloomBlur", bloomK);
+    bloomBlur->configureKernel(bloomBlurKernelRadius, bloomBlurKernelSigma, "rgb");
 
     createInfo.format = Texture::Red16F;
     createInfo.width = width() * dofK;
     createInfo.height = height() * dofK;
 
-    cocBlur = PtrMaker::make<Blur>(createInfo);
-    cocBlur->setPingPongShaders(Blur::getPingPongShaders(cocBlurKernelRadius, "r"));
+    cocBlur = PtrMaker::make<GaussianBlur>(getBlurMode(cocBlurKernelRadius), createInfo);
+    cocBlur->setPrograms(blurPrograms);
     cocBlur->setQuadRenderer(quadRenderer);
-    cocBlur->configureKernel(cocBlurKernelRadius, cocBlurKernelSigma);
+    cocBlur->setTargetPool(&targetPool, "cocBlur", dofK);
+    cocBlur->configureKernel(cocBlurKernelRadius, cocBlurKernelSigma, "r");
 
     createInfo.format = Texture::RGB16F;
 
-    dofBlur = PtrMaker::make<Blur>(createInfo);
-    dofBlur->setPingPongShaders(Blur::getPingPongShaders(dofBlurKernelRadius, "rgb"));
+    dofBlur = PtrMaker::make<GaussianBlur>(getBlurMode(dofBlurKernelRadius), createInfo);
+    dofBlur->setPrograms(blurPrograms);
     dofBlur->setQuadRenderer(quadRenderer);
-    dofBlur->configureKernel(dofBlurKernelRadius, dofBlurKernelSigma);
-
-    RenderbufferPtr rbo = PtrMaker::make();
-    rbo->bind();
-    rbo->setDimensions(width(), height());
-    rbo->setFormat(Texture::DepthComponent);
-    rbo->update();
-    rbo->unbind();
+    dofBlur->setTargetPool(&targetPool, "dofBlur", dofK);
+    dofBlur->configureKernel(dofBlurKernelRadius, dofBlurKernelSigma, "rgb");
 
+    // depth is sampled by SSR and CoC in the compact mode
     displayFb->bind();
-    displayFb->attachRenderbuffer(rbo, Framebuffer::DepthAttachment);
+    displayFb->attachTexture(depthTex, Framebuffer::DepthAttachment);
     displayFb->addOutputList(); // 2-nd list
 
-    {
-        auto &list = displayFb->getOutputList(0);
-        list.addColor(0);
-        list.addColor(1);
-        list.addColor(2);
-        list.addColor(3);
-    }
+    if (compactGBuffer) {
+        displayFb->getOutputList(0).addColor(0);
+        displayFb->getOutputList(0).addColor(1);
+        displayFb->getOutputList(0).addColor(2);
+        displayFb->getOutputList(1).addColor(0); // skybox doesn't need position
+
+        displayFb->attachTexture(colorTex, Framebuffer::ColorAttachmentZero + 0);
+        displayFb->attachTexture(normalTex, Framebuffer::ColorAttachmentZero + 1);
+        displayFb->attachTexture(ssrValues, Framebuffer::ColorAttachmentZero + 2);
+    } else {
+        {
+            auto &list = displayFb->getOutputList(0);
+            list.addColor(0);
+            list.addColor(1);
+            list.addColor(2);
+            list.addColor(3);
+        }
 
-    {
-        auto &list = displayFb->getOutputList(1);
-        list.addColor(0);
-        list.addColor(2);
+        {
+            auto &list = displayFb->getOutputList(1);
+            list.addColor(0);
+            list.addColor(2);
+        }
+
+        displayFb->attachTexture(colorTex, Framebuffer::ColorAttachmentZero + 0);
+        displayFb->attachTexture(normalTex, Framebuffer::ColorAttachmentZero + 1);
+        displayFb->attachTexture(positionTex, Framebuffer::ColorAttachmentZero + 2);
+        displayFb->attachTexture(ssrValues, Framebuffer::ColorAttachmentZero + 3);
     }
 
-    displayFb->attachTexture(colorTex, Framebuffer::ColorAttachmentZero + 0);
-    displayFb->attachTexture(normalTex, Framebuffer::ColorAttachmentZero + 1);
-    displayFb->attachTexture(positionTex, Framebuffer::ColorAttachmentZero + 2);
-    displayFb->attachTexture(ssrValues, Framebuffer::ColorAttachmentZero + 3);
+    displayFb->unbind();
 
-    screenspaceFb->bind();
-    screenspaceFb->attachTexture(screenspaceTex, Framebuffer::ColorAttachmentZero);
+    if (ssrMode != SSRMode::Linear)
+        hiZ.setProgram(hiZShader);
 
-    bloomSearchFb->bind();
-    bloomSearchFb->attachTexture(bloomTex, Framebuffer::ColorAttachmentZero);
+    // transient targets, in the order of renderScene; the ones with the same format
+    // and scale, which aren't used at the same time, share the textures
+    using Pool = RenderTargetPool;
 
-    cocFb->bind();
-    cocFb->attachTexture(cocTex, Framebuffer::ColorAttachmentZero);
-    cocFb->unbind();
+    auto screenspace = targetPool.create("screenspace", Pool::DefaultFormat);
+    auto bloom = targetPool.create("bloom", Pool::DefaultFormat, bloomK);
+    auto coc = targetPool.create("coc", Texture::Red16F, dofK);
+    auto ssrHit = Pool::None;
+
+    if (ssrMode == SSRMode::Linear) {
+        targetPool.addPass("ssr", {}, {screenspace});
+    } else {
+        // hit uv needs more precision than half float has
+        ssrHit = targetPool.create("ssrHit", GL_RGBA16, ssrMode == SSRMode::HiZHalf ? 0.5f : 1.0f);
+
+        targetPool.addPass("ssrTrace", {}, {ssrHit});
+        targetPool.addPass("ssrResolve", {ssrHit}, {screenspace});
+    }
+
+    targetPool.addPass("bloomSearch", {screenspace}, {bloom});
+    bloomBlur->declarePasses(bloom);
+    targetPool.addPass("coc", {}, {coc});
+    cocBlur->declarePasses(coc);
+    dofBlur->declarePasses(screenspace);
+    targetPool.addPass("blend", {screenspace, bloomBlur->getOutputTarget(), dofBlur->getOutputTarget(), cocBlur->getOutputTarget()}, {});
+    targetPool.compile();
+
+    // textures are resized in place, so they are taken once
+    screenspaceFb = targetPool.getFramebuffer(screenspace);
+    screenspaceTex = targetPool.get(screenspace);
+    bloomSearchFb = targetPool.getFramebuffer(bloom);
+    bloomTex = targetPool.get(bloom);
+    cocFb = targetPool.getFramebuffer(coc);
+    cocTex = targetPool.get(coc);
+
+    if (ssrHit != Pool::None) {
+        ssrHitFb = targetPool.getFramebuffer(ssrHit);
+        ssrHitTex = targetPool.get(ssrHit);
+    }
+
+    targetPool.setWindowSize(width(), height());
+    targetPool.update();
 
     // configuring CS
     colorShader->bind();
@@ -396,9 +757,26 @@ void ExampleChessContent::initShaders() {
 
     // screen space setting
     ssrShader->bind();
-    ssrShader->setInt("normalMap", 1);
-    ssrShader->setInt("ssrValuesMap", 2);
-    ssrShader->setInt("positionMap", 3);
+    ssrShader->setInt(SSRShader::Vars::NormalMap, 1);
+    ssrShader->setInt(SSRShader::Vars::SSRValuesMap, 2);
+    ssrShader->setFloat(SSRShader::Vars::MinReflectionStrength, ssrMinReflectionStrength);
+
+    if (ssrMode == SSRMode::Linear) {
+        ssrShader->setInt(compactGBuffer ? SSRShader::Vars::DepthMap : SSRShader::Vars::PositionMap, 3);
+    } else {
+        int traceScale = ssrMode == SSRMode::HiZHalf ? 2 : 1;
+
+        ssrShader->setInt(SSRShader::Vars::DepthMap, 3);
+        ssrShader->setInt(SSRShader::Vars::HiZMap, 4);
+        ssrShader->setInt(SSRShader::Vars::TraceScale, traceScale);
+
+        ssrResolveShader->bind();
+        ssrResolveShader->setInt(SSRShader::Vars::BaseImage, 0);
+        ssrResolveShader->setInt(SSRShader::Vars::DepthMap, 1);
+        ssrResolveShader->setInt(SSRShader::Vars::HitMap, 2);
+        ssrResolveShader->setInt(SSRShader::Vars::TraceScale, traceScale);
+    }
+
     ssrShader->unbind();
 
     resize();
@@ -422,32 +800,84 @@ void ExampleChessContent::initCamera() {
 #define modelsPath resources "models/"
 
 void ExampleChessContent::createModels() {
-    auto getModel = [](const string &path)
-    {
-        ModelCreator modelCreator;
-        modelCreator.importFromFile(modelsPath + path);
-
-        return modelCreator.get();
+    const char *modelPaths[] = {
+        modelsPath "chess/Classic Chess small.json",
+        modelsPath "man/man.json",
+        modelsPath "astroboy/astroboy_walk.json"
     };
 
-    models.emplace_back(getModel("chess/Classic Chess small.json"));
-    models.emplace_back(getModel("man/man.json"));
-    models.emplace_back(getModel("astroboy/astroboy_walk.json"));
+    // materials get the textures registered by the loader (compressed, if baked),
+    // so they must be ready before the models are created
+    vector<shared_future<Texture2DPtr>> textureFutures;
+
+    for (auto path : modelPaths) {
+        auto futures = assetLoader.loadMaterialTextures(path);
+        textureFutures.insert(textureFutures.end(), futures.begin(), futures.end());
+    }
+
+    for (auto &future : textureFutures)
+        assetLoader.wait(future);
+
+    vector<shared_future<ModelPtr>> modelFutures;
+
+    for (auto path : modelPaths)
+        modelFutures.emplace_back(assetLoader.loadModel(path));
+
+    for (auto &future : modelFutures) {
+        auto model = assetLoader.wait(future);
+        computeBounds(model->getShape());
+        models.emplace_back(model);
+    }
+
+    // animated man: the first two animations, blended by the factor (keys 1 and 2)
+    auto manClip0 = manBlendTree.addClip(0);
+    auto manClip1 = manBlendTree.addClip(1);
+    manBlend = manBlendTree.addBlend({manClip0, manClip1});
+    manBlendTree.setRoot(manBlend);
+    setManBlendFactor(0.25f);
+
+    manAnimator.init(models[1]->getShape());
+
+    manBones = *models[1]->getBones();
+    models[1]->setBones(&manBones);
+
+    // LOD bones replace the model's bones, so it must be done before they are linked
+    for (uint i = 0; i < models.size(); i++) {
+        auto &shape = models[i]->getShape();
+        AnimationLod::Config lodConfig;
+
+        if (shape->isBonesPresent() && AnimationLod::loadConfig(modelPaths[i], lodConfig)) {
+            animationLod.add(models[i], getBounds(shape).bounds, lodConfig);
+        }
+    }
 
-    // animated man
-    manAnimationBlender.setModel(models[1]);
-    manAnimationBlender.setFactor(0.25f);
-    manAnimationBlender.setLhsAnim(0);
-    manAnimationBlender.setRhsAnim(1);
+    vector<ShaderProgramPtr> bonePrograms {colorShader, dirShadowShader, pointShadowShader};
 
-    models[1]->setBones(&manAnimationBlender.bones());
+    if (skinningShader)
+        bonePrograms.emplace_back(skinningShader);
 
     boneManager.setBindingPoint(0);
-    boneManager.setShaderPrograms({colorShader, dirShadowShader, pointShadowShader});
+    boneManager.setShaderPrograms(bonePrograms);
     boneManager.setMaxModelsCount(2);
     boneManager.init();
     boneManager.getBlockBufferStorage().bind();
     boneManager.addModels({models[1], models[2]});
+
+    if (skinningShader) {
+        // layout 0 - shadows, layout 1 - color
+        PreSkinning::LayoutLocations shadowLocations {0};
+        shadowLocations.position = pointShadowShader->getLocation(PointShadowShader::Vars::InPos);
+
+        PreSkinning::LayoutLocations colorLocations {1};
+        colorLocations.position = colorShader->getLocation(ColorShader::Vars::InPos);
+        colorLocations.normal = colorShader->getLocation(ColorShader::Vars::InNormal);
+        colorLocations.tangent = colorShader->getLocation(ColorShader::Vars::InTangent);
+        colorLocations.bitangent = colorShader->getLocation(ColorShader::Vars::InBitangent);
+
+        for (auto &model : {models[1], models[2]}) {
+            preSkinning.addModel(model, 1, colorShader, {shadowLocations, colorLocations});
+        }
+    }
 }
 
 void ExampleChessContent::initLamps() {
@@ -462,11 +892,13 @@ void ExampleChessContent::initLamps() {
     lightManager.setBindingPoint(1);
     lightManager.init();
 
-    // create models
-    ShapeCreator creator;
-    creator.importFromFile(modelsPath "japanese_lamp/japanese_lamp.shape.json");
+    // lamps and lighting params are written to the staging copy of the lighting block
+    // and uploaded at once. From now on the block is written only through it, see UniformBlockStaging
+    lightingBlock.init(colorShader, lightManager.getBindingPoint());
 
-    auto lampShape = creator.get();
+    // create models
+    auto lampShape = assetLoader.wait(assetLoader.loadShape(modelsPath "japanese_lamp/japanese_lamp.shape.json"));
+    computeBounds(lampShape);
 
     lamps.resize(2); // TODO
     pointLamps.resize(1);
@@ -489,14 +921,24 @@ void ExampleChessContent::initLamps() {
     lamps[1]->translate();
     lamps[1]->transform();
 
-    // write some lighting params
-    lightManager.bindBuffer();
-    lightManager.writePointLightsCount(pointLamps.size());
-    lightManager.writeDirLightsCount(dirLamps.size());
-    lightManager.writeShadowOpacity(shadowOpacity);
-    lightManager.writeShadowDiskRadiusK(diskRadius_k);
-    lightManager.writeShadowDiskRadiusMin(diskRadius_min);
-    lightManager.unbindBuffer();
+    // lamps share the shape, so they are drawn by instancing
+    lampsGroup.setShape(lampShape, 2);
+    lampsGroup.addModel(lamps[0]);
+    lampsGroup.addModel(lamps[1]);
+
+    lightingBlock.setUint("pointLightsCount", static_cast<uint>(pointLamps.size()));
+    lightingBlock.setUint("dirLightsCount", static_cast<uint>(dirLamps.size()));
+    lightingBlock.setFloat("shadowOpacity", shadowOpacity);
+    lightingBlock.setFloat("diskRadius_k", diskRadius_k);
+    lightingBlock.setFloat("diskRadius_min", diskRadius_min);
+    lightingBlock.flush();
+
+    // positions are updated per frame by sendLampsData
+    for (size_t i = 0; i < pointLamps.size(); i++)
+        pointLampPosLocations.push_back(lightingBlock.getLocation("pointLights[" + to_string(i) + "].pos"));
+
+    for (size_t i = 0; i < dirLamps.size(); i++)
+        dirLampPosLocations.push_back(lightingBlock.getLocation("dirLights[" + to_string(i) + "].pos"));
 }
 
 void ExampleChessContent::initShadowMaps() {
@@ -511,6 +953,9 @@ void ExampleChessContent::initShadowMaps() {
         lightManager.pushShadowMap(dirLamps[i], i);
 
     colorShader->unbind();
+
+    pointShadowCaches.resize(pointLamps.size());
+    dirShadowCaches.resize(dirLamps.size());
 }
 
 void ExampleChessContent::initDOF() {
@@ -521,83 +966,309 @@ void ExampleChessContent::initDOF() {
     dofCoCShader->unbind();
 }
 
-void ExampleChessContent::sendLampsData() {
-    lightManager.bindBuffer();
+void ExampleChessContent::updateSimulation() {
+    double time;
+
+    if (timeOverride >= 0.0f) {
+        // deterministic playback: the simulation is stepped by the render thread
+        lampThread.stopLoop();
+        lampThread.advanceTo(timeOverride);
+        time = timeOverride;
+    } else {
+        lampThread.startLoop();
+        time = lampThread.getClock();
+    }
 
-    for (size_t i = 0; i < pointLamps.size(); i++)
-        lightManager.writePos(pointLamps[i], i);
+    // interpolate between the two last ticks
+    auto &state = lampThread.getState();
+    auto dt = lampThread.getTickDuration();
+    auto alpha = glm::clamp(static_cast<float>(time - state.time) / dt + 1.0f, 0.0f, 1.0f);
 
-    for (size_t i = 0; i < dirLamps.size(); i++)
-        lightManager.writePos(dirLamps[i], i);
+    pointLamps[0].setPos(glm::mix(state.prevPos, state.pos, alpha));
+    pointLamps[0].translate();
+}
+
+void ExampleChessContent::initAnimationJobs() {
+    // models are animated independently, so each model is a separate job.
+    // Render thread takes part in the execution, see JobGraph::run
+    for (auto &model : models) {
+        if (!model->getShape()->isBonesPresent())
+            continue;
 
-    lightManager.unbindBuffer();
+        animationJobs.add([this, model]() {
+            // blending is a part of the man's pose, so it is sampled together with the animations
+            auto evaluate = [this, &model](float time) {
+                auto animator = model->getAnimator();
+
+                if (model == models[1]) {
+                    animateMan(time);
+                    return;
+                }
+
+                auto animationsAmount = model->getShape()->getAnimationsAmount();
+
+                for (uint j = 0; j < animationsAmount; j++) {
+                    animator->setAnimationIndex(j);
+                    animator->animate(time);
+                }
+            };
+
+            if (!animationLod.animate(model, evaluate)) {
+                evaluate(animationTime);
+            }
+        });
+    }
+
+    for (auto &lamp : pointLamps) {
+        animationJobs.add([&lamp]() {
+            lamp.mptr->transform();
+        });
+    }
 }
 
-glm::mat4 ExampleChessContent::getMVPMatrix(const glm::mat4 &modelMatrix) {
-    return camera.getProjectionMatrix() * camera.getViewMatrix() * modelMatrix;
+void ExampleChessContent::setManBlendFactor(float factor) {
+    manBlendFactor = glm::clamp(factor, 0.0f, 1.0f);
+    manBlendTree.setWeights(manBlend, {1.0f - manBlendFactor, manBlendFactor});
+
+    if (!models.empty())
+        animationLod.invalidate(models[1]);
+
+    ++bonesVersion;
 }
 
-glm::mat4 ExampleChessContent::getMVMatrix(const glm::mat4 &modelMatrix) {
-    return camera.getViewMatrix() * modelMatrix;
+void ExampleChessContent::animateMan(float time) {
+    // only the clips with non-zero weights are sampled
+    manBlendTree.invalidateClips();
+
+    bool changed = manBlendTree.evaluate([&](uint clip, BlendTree::Pose &pose) {
+        manAnimator.animate(clip, time, pose);
+    });
+
+    if (!changed)
+        return;
+
+    auto &pose = manBlendTree.getPose();
+
+    for (uint i = 0; i < pose.size(); i++) {
+        manBones[i] = pose[i];
+    }
+}
+
+void ExampleChessContent::sendLampsData() {
+    // unchanged positions are skipped by the staging,
+    // all changes are uploaded at once
+    for (size_t i = 0; i < pointLamps.size(); i++)
+        lightingBlock.setVec3(pointLampPosLocations[i], pointLamps[i].m_pos);
+
+    for (size_t i = 0; i < dirLamps.size(); i++)
+        lightingBlock.setVec3(dirLampPosLocations[i], dirLamps[i].m_pos);
+
+    lightingBlock.flush();
 }
 
 void ExampleChessContent::updateMatrices(const glm::mat4 &modelMatrix) {
-    colorShader->setMat4(ColorShader::Vars::MVPMatrix, getMVPMatrix(modelMatrix));
-    colorShader->setMat4(ColorShader::Vars::MVMatrix, getMVMatrix(modelMatrix));
-    colorShader->setMat4(ColorShader::Vars::ModelMatrix, modelMatrix);
-    colorShader->setMat4(ColorShader::Vars::ViewMatrix, camera.getViewMatrix());
+    // view and projection are taken from the frame uniform block
+    colorUniforms.set<ColorShader::Vars::ModelMatrix>(modelMatrix);
 }
 
-void ExampleChessContent::drawModelDM(ModelPtr &model, ShaderProgramPtr &program, const glm::mat4 &mat) {
+void ExampleChessContent::drawModelDM(ModelPtr &model, UniformCache &uniforms, const VolumeTest &isVisible,
+                                      CullingStats &stats, const glm::mat4 &mat, uint instancesCount)
+{
     auto &shape = model->getShape();
+    auto &meshes = shape->getMeshes();
+    auto &bounds = getBounds(shape);
+    auto &transformation = model->transformation();
+
+    if (!isVisible(bounds.bounds.transform(transformation))) {
+        stats.culled += meshes.size();
+        return;
+    }
+
     shape->getInputLayout(0)->bind();
 
     boneManager.linkBuffer(model);
 
-    program->setMat4(ShadowShader::Vars::TransformationMatrix, mat * model->transformation());
+    uniforms.set<ShadowShader::Vars::TransformationMatrix>(mat * transformation);
+    uniforms.set<SkinningShader::Vars::PreSkinned>(static_cast<int>(preSkinning.isPreSkinned(model)));
+
+    for (usize i = 0; i < meshes.size(); i++) {
+        if (!isVisible(bounds.meshes[i].transform(transformation))) {
+            ++stats.culled;
+        } else if (instancesCount == 1) {
+            Engine::drawElements(meshes[i].start, meshes[i].count);
+            ++stats.drawn;
+        } else {
+            auto offset = reinterpret_cast<void*>(static_cast<uintptr_t>(meshes[i].start) * sizeof(uint));
+            glDrawElementsInstanced(GL_TRIANGLES, meshes[i].count, GL_UNSIGNED_INT, offset, instancesCount);
+            ++stats.drawn;
+        }
+    }
+}
+
+void ExampleChessContent::drawGroupDM(InstancedModelGroup &group, UniformCache &uniforms, const VolumeTest &isVisible,
+                                      CullingStats &stats, const ModelPtr &exclude, const glm::mat4 &mat, uint repeat)
+{
+    auto &shape = group.getShape();
+    auto &meshes = shape->getMeshes();
+    auto &bounds = getBounds(shape);
+
+    auto instances = group.update([&](const ModelPtr &model) {
+        if (model == exclude)
+            return false;
+
+        if (!isVisible(bounds.bounds.transform(model->transformation()))) {
+            stats.culled += meshes.size();
+            return false;
+        }
+
+        return true;
+    });
+
+    if (instances == 0)
+        return;
+
+    group.bind(0);
 
-    for (auto &mesh : shape->getMeshes()) {
-        Engine::drawElements(mesh.start, mesh.count);
+    // models of the group have no bones, so it resets bones of the previous model
+    boneManager.linkBuffer(group.getModels().front());
+
+    uniforms.set<ShadowShader::Vars::TransformationMatrix>(mat);
+    uniforms.set<SkinningShader::Vars::PreSkinned>(0);
+
+    for (auto &mesh : meshes) {
+        group.drawElements(mesh.start, mesh.count, repeat);
+        stats.drawn += instances;
     }
 }
 
-void ExampleChessContent::drawModel(ModelPtr &model) {
+void ExampleChessContent::queueModel(const ModelPtr &model, const Frustum &frustum) {
     auto &shape = model->getShape();
-    shape->getInputLayout(1)->bind();
+    auto &bounds = getBounds(shape);
+    auto &transformation = model->transformation();
+    auto meshesCount = shape->getMeshes().size();
 
-    boneManager.linkBuffer(model);
+    if (!frustum.intersects(bounds.bounds.transform(transformation))) {
+        colorCulling.culled += meshesCount;
+        return;
+    }
 
-	updateMatrices(model->transformation());
+    float depth = -(camera.getViewMatrix() * transformation[3]).z;
 
-    for (auto &mesh : shape->getMeshes()) {
-        using namespace ColorShader::Vars;
+    for (usize i = 0; i < meshesCount; i++) {
+        if (frustum.intersects(bounds.meshes[i].transform(transformation))) {
+            renderQueue.add(model, 1, i, depth);
+            ++colorCulling.drawn;
+        } else {
+            ++colorCulling.culled;
+        }
+    }
+}
 
-        auto useNotNull = [](const Texture2DPtr &tex, uint slot) {
-            if (tex != nullptr) {
-                tex->use(slot);
-            } else {
-                Engine::defaultTexture2D()->use(slot);
-            }
-        };
+void ExampleChessContent::queueGroup(InstancedModelGroup &group, const Frustum &frustum) {
+    auto &shape = group.getShape();
+    auto &bounds = getBounds(shape);
+    auto meshesCount = shape->getMeshes().size();
+
+    float depth = FLT_MAX;
 
-        const auto &material = mesh.material;
-        useNotNull(material.getTexture2D(Material::AmbientTexture, nullptr), 0);
-        useNotNull(material.getTexture2D(Material::DiffuseTexture, nullptr), 1);
-        useNotNull(material.getTexture2D(Material::SpecularTexture, nullptr), 2);
-        useNotNull(material.getTexture2D(Material::NormalTexture, nullptr), 3);
-        useNotNull(material.getTexture2D(Material::ReflectionTexture, nullptr), 4);
-        useNotNull(material.getTexture2D(Material::JitterTexture, nullptr), 5);
+    auto instances = group.update([&](const ModelPtr &model) {
+        auto &transformation = model->transformation();
 
-        colorShader->setFloat(AmbientStrength, material.getFloat(Material::AmbientStrength, 0.01f));
-        colorShader->setFloat(DiffuseStrength, material.getFloat(Material::DiffuseStrength, 1.0f));
-        colorShader->setFloat(SpecularStrength, material.getFloat(Material::SpecularStrength, 1.0f));
-        colorShader->setFloat(Shininess, material.getFloat(Material::Shininess, 0.01f));
+        if (!frustum.intersects(bounds.bounds.transform(transformation))) {
+            colorCulling.culled += meshesCount;
+            return false;
+        }
+
+        depth = glm::min(depth, -(camera.getViewMatrix() * transformation[3]).z);
+
+        return true;
+    });
+
+    if (instances == 0)
+        return;
+
+    for (usize i = 0; i < meshesCount; i++) {
+        renderQueue.add(&group, 1, i, depth);
+        colorCulling.drawn += instances;
+    }
+}
 
-        Engine::drawElements(mesh.start, mesh.count);
+void ExampleChessContent::computeBounds(const ShapePtr &shape) {
+    if (shapeBounds.find(shape.get()) == shapeBounds.end()) {
+        shapeBounds[shape.get()] = computeShapeBounds(shape, 1, colorShader->getLocation(ColorShader::Vars::InPos));
     }
 }
 
+const ShapeBounds& ExampleChessContent::getBounds(const ShapePtr &shape) const {
+    return shapeBounds.at(shape.get());
+}
+
+ExampleChessContent::VolumeTest ExampleChessContent::getPointLightVolume(uint index) const {
+    auto &lamp = pointLamps[index];
+    Sphere volume {lamp.m_pos, getLightRadius(lamp.m_kc, lamp.m_kl, lamp.m_kq)};
+
+    return [volume](const AABB &box) {
+        return volume.intersects(box);
+    };
+}
+
+ExampleChessContent::VolumeTest ExampleChessContent::getDirLightVolume(uint index) const {
+    Frustum volume(dirLamps[index].getLightSpaceMatrix());
+
+    return [volume](const AABB &box) {
+        return volume.intersects(box);
+    };
+}
+
+void ExampleChessContent::addShadowCasters(ShadowCache &cache, const VolumeTest &isVisible, const ModelPtr &model) {
+    auto &shape = model->getShape();
+    auto &transformation = model->transformation();
+
+    if (!isVisible(getBounds(shape).bounds.transform(transformation)))
+        return;
+
+    cache.addCaster(model.get(), transformation, shape->isBonesPresent() ? animationLod.getBonesVersion(model, bonesVersion) : 0);
+}
+
+bool ExampleChessContent::isPointShadowDirty(uint index) {
+    auto &cache = pointShadowCaches[index];
+    auto isVisible = getPointLightVolume(index);
+
+    cache.begin(glm::translate(glm::mat4(1.0f), pointLamps[index].m_pos));
+
+    for (auto &model : models)
+        addShadowCasters(cache, isVisible, model);
+
+    for (auto &lamp : lampsGroup.getModels()) {
+        if (lamp != pointLamps[index].mptr) {
+            addShadowCasters(cache, isVisible, lamp);
+        }
+    }
+
+    return cache.end();
+}
+
+bool ExampleChessContent::isDirShadowDirty(uint index) {
+    auto &cache = dirShadowCaches[index];
+    auto isVisible = getDirLightVolume(index);
+
+    cache.begin(dirLamps[index].getLightSpaceMatrix());
+
+    for (auto &model : models)
+        addShadowCasters(cache, isVisible, model);
+
+    for (auto &lamp : lampsGroup.getModels()) {
+        if (lamp != dirLamps[index].mptr) {
+            addShadowCasters(cache, isVisible, lamp);
+        }
+    }
+
+    return cache.end();
+}
+
 void ExampleChessContent::renderToDepthCubemap(uint index) {
+    ProfileZone zone(&profiler, "renderToDepthCubemap");
+
     pointLamps[index].begin();
     pointLamps[index].updateMatrix();
     pointLamps[index].getShadowFramebuffer()->clearDepthBuffer();
@@ -605,61 +1276,115 @@ void ExampleChessContent::renderToDepthCubemap(uint index) {
     lightManager.pushShadowShaderPos(pointLamps[index]);
 	lightManager.pushShadowShaderMatrices(pointLamps[index]);
 
-	// drawing models
-    for (auto &model : models)
-        drawModelDM(model, pointShadowShader);
+    // only casters inside the light volume are drawn
+    auto isVisible = getPointLightVolume(index);
+
+    switch (pointShadowMode) {
+        case PointShadowMode::GeometryShader:
+            drawPointShadowCasters(index, isVisible);
+            break;
+        case PointShadowMode::Instanced:
+            drawPointShadowCasters(index, isVisible, 6);
+            break;
+        case PointShadowMode::PerFace: {
+            GLint cubemap;
+            glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                    GL_FRAMEBUFFER_ATTACHMENT_OBJECT_NAME, &cubemap);
+
+            auto &lamp = pointLamps[index];
+            float radius = getLightRadius(lamp.m_kc, lamp.m_kl, lamp.m_kq);
 
-	// drawing lamps
-	for (uint i = 0; i < pointLamps.size(); i++) {
-		if (i == index)
-		    continue;
+            for (uint face = 0; face < 6; face++) {
+                glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                        GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, cubemap, 0);
 
-        drawModelDM(pointLamps[i].mptr, pointShadowShader);
-	}
+                pointShadowUniforms.set<PointShadowShader::Vars::Face>(static_cast<int>(face));
+
+                Frustum faceFrustum(getCubeFaceMatrix(lamp.m_pos, face, radius));
+
+                drawPointShadowCasters(index, [&](const AABB &box) {
+                    return isVisible(box) && faceFrustum.intersects(box);
+                });
+            }
+
+            // restore the layered attachment
+            glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, cubemap, 0);
+
+            break;
+        }
+    }
 
 	pointLamps[index].end();
 }
 
+void ExampleChessContent::drawPointShadowCasters(uint index, const VolumeTest &isVisible, uint instancesCount) {
+    glm::mat4 identity(1.0f);
+
+	// drawing models
+    for (auto &model : models)
+        drawModelDM(model, pointShadowUniforms, isVisible, pointShadowCulling, identity, instancesCount);
+
+	// drawing lamps, except the own one
+    drawGroupDM(lampsGroup, pointShadowUniforms, isVisible, pointShadowCulling, pointLamps[index].mptr,
+                identity, instancesCount);
+}
+
 void ExampleChessContent::renderToDepthMap(uint index) {
+    ProfileZone zone(&profiler, "renderToDepthMap");
+
     dirLamps[index].begin();
     dirLamps[index].getShadowFramebuffer()->clearDepthBuffer();
 
+    // only casters inside the ortho box are drawn
+    auto &lightSpaceMatrix = dirLamps[index].getLightSpaceMatrix();
+    auto isVisible = getDirLightVolume(index);
+
 	// drawing models
     for (auto &model : models)
-        drawModelDM(model, dirShadowShader, dirLamps[index].getLightSpaceMatrix());
+        drawModelDM(model, dirShadowUniforms, isVisible, dirShadowCulling, lightSpaceMatrix);
 
-	// drawing lamps
-	for (uint i = 0; i < dirLamps.size(); i++) {
-		if (i == index)
-		    continue;
-
-        drawModelDM(dirLamps[i].mptr, dirShadowShader, dirLamps[index].getLightSpaceMatrix());
-	}
+	// drawing lamps, except the own one
+    drawGroupDM(lampsGroup, dirShadowUniforms, isVisible, dirShadowCulling, dirLamps[index].mptr, lightSpaceMatrix);
 
 	dirLamps[index].end();
 }
 
 void ExampleChessContent::renderScene() {
+    ProfileZone zone(&profiler, "renderScene");
+
+    beginPass(PassTimer::GBuffer);
     displayFb->bind();
     displayFb->setActiveOutputList(0);
     displayFb->update();
     displayFb->clear(Framebuffer::ColorBuffer | Framebuffer::DepthBuffer);
 
-    Engine::setViewport(width(), height());
+    Engine::setViewport(targetPool.getWidth(), targetPool.getHeight());
 
     colorShader->bind();
 
     // sending lamps parameters to fragment shader
 	sendLampsData();
 
-    // drawing
+    // drawing: meshes are sorted by material to skip redundant state changes
+    renderQueue.clear();
+
+    Frustum frustum(camera.getProjectionMatrix() * camera.getViewMatrix());
+
     for (auto &model : models)
-        drawModel(model);
+        queueModel(model, frustum);
 
-	for (auto &lamp : lamps)
-	    drawModel(lamp);
+    queueGroup(lampsGroup, frustum);
+
+    renderQueue.submit([this](ModelPtr &model, bool instanced) {
+        boneManager.linkBuffer(model);
+        updateMatrices(instanced ? glm::mat4(1.0f) : model->transformation());
+        colorUniforms.set<SkinningShader::Vars::PreSkinned>(static_cast<int>(preSkinning.isPreSkinned(model)));
+    });
+
+    endPass(PassTimer::GBuffer);
 
     // render skybox
+    beginPass(PassTimer::Skybox);
     displayFb->setActiveOutputList(1);
     displayFb->update();
 
@@ -671,34 +1396,73 @@ void ExampleChessContent::renderScene() {
     skyboxRenderer->getInputLayout()->bind();
     skyboxRenderer->draw();
     Engine::setDepthTestMode(Engine::DepthTest::Less);
+    endPass(PassTimer::Skybox);
 
     // postprocessing
     quadRenderer->getInputLayout()->bind();
 
-    screenspaceFb->bind();
-    ssrShader->bind();
-    colorTex->use(0);
-    normalTex->use(1);
-    ssrValues->use(2);
-    positionTex->use(3);
-    quadRenderer->draw();
+    if (ssrMode == SSRMode::Linear) {
+        beginPass(PassTimer::SSR);
+        screenspaceFb->bind();
+        ssrShader->bind();
+        colorTex->use(0);
+        normalTex->use(1);
+        ssrValues->use(2);
+        (compactGBuffer ? depthTex : positionTex)->use(3);
+        quadRenderer->draw();
+        endPass(PassTimer::SSR);
+    } else {
+        beginPass(PassTimer::HiZ);
+        hiZ.build(depthTex, quadRenderer);
+        endPass(PassTimer::HiZ);
+
+        // hits are traced at the trace scale and applied at the full resolution
+        beginPass(PassTimer::SSR);
+        Engine::setViewport(ssrHitTex->getWidth(), ssrHitTex->getHeight());
+        ssrHitFb->bind();
+        ssrShader->bind();
+        normalTex->use(1);
+        ssrValues->use(2);
+        depthTex->use(3);
+        hiZ.use(4);
+        quadRenderer->draw();
+
+        Engine::setViewport(targetPool.getWidth(), targetPool.getHeight());
+        screenspaceFb->bind();
+        ssrResolveShader->bind();
+        colorTex->use(0);
+        depthTex->use(1);
+        ssrHitTex->use(2);
+        quadRenderer->draw();
+        endPass(PassTimer::SSR);
+    }
 
-    Engine::setViewport(width() * bloomK, height() * bloomK);
+    beginPass(PassTimer::Bloom);
+    Engine::setViewport(bloomTex->getWidth(), bloomTex->getHeight());
     bloomSearchFb->bind();
     bloomSearchFb->clearColorBuffer();
     bloomSearchShader->bind();
     screenspaceTex->use(0);
     quadRenderer->draw();
     bloomBlur->makeBlur(bloomTex.get());
+    endPass(PassTimer::Bloom);
 
-    Engine::setViewport(width() * dofK, height() * dofK);
+    beginPass(PassTimer::CoC);
+    Engine::setViewport(cocTex->getWidth(), cocTex->getHeight());
     cocFb->bind();
     dofCoCShader->bind();
-    positionTex->use(0);
+    (compactGBuffer ? depthTex : positionTex)->use(0);
     quadRenderer->draw();
 
     cocBlur->makeBlur(cocTex.get());
+    endPass(PassTimer::CoC);
+
+    beginPass(PassTimer::DOF);
     dofBlur->makeBlur(screenspaceTex.get());
+    endPass(PassTimer::DOF);
+
+    // the render size may be bucketed, the output is scaled to the window
+    beginPass(PassTimer::Blend);
     Engine::setViewport(width(), height());
 
     Engine::defaultFramebuffer()->bind();
@@ -710,4 +1474,28 @@ void ExampleChessContent::renderScene() {
     cocBlur->get()->use(3);
     quadRenderer->draw();
     blendShader->unbind();
+    endPass(PassTimer::Blend);
+}
+
+float ExampleChessContent::getTime() const {
+    if (timeOverride >= 0.0f)
+        return timeOverride;
+
+    return (float) Engine::timeFromStart() / 1000.0f;
+}
+
+void ExampleChessContent::beginPass(PassTimer::Pass pass) {
+    profiler.beginZone(PassTimer::getPassName(pass));
+
+    if (passTimer) {
+        passTimer->begin(pass);
+    }
+}
+
+void ExampleChessContent::endPass(PassTimer::Pass pass) {
+    if (passTimer) {
+        passTimer->end(pass);
+    }
+
+    profiler.endZone();
 }
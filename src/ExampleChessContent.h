@@ -7,7 +7,7 @@
 
 #include <algine/std/model/ShapePtr.h>
 #include <algine/std/model/ModelPtr.h>
-#include <algine/std/animation/AnimationBlender.h>
+#include <algine/std/animation/BonesStorage.h>
 #include <algine/std/animation/BoneSystemManager.h>
 #include <algine/std/CubeRendererPtr.h>
 #include <algine/std/QuadRendererPtr.h>
@@ -17,16 +17,67 @@
 #include <algine/ext/lighting/PointLamp.h>
 #include <algine/ext/lighting/DirLamp.h>
 #include <algine/ext/lighting/LightingManager.h>
-#include <algine/std/Blur.h>
 
+#include <unordered_map>
+#include <functional>
 #include <vector>
+#include <cstdint>
 
 #include "LampMoveThread.h"
+#include "JobSystem.h"
+#include "AssetLoader.h"
+#include "ProgramCache.h"
+#include "UniformCache.h"
+#include "FrameUniforms.h"
+#include "HiZPyramid.h"
+#include "GaussianBlur.h"
+#include "RenderTargetPool.h"
+#include "PreSkinning.h"
+#include "AnimationLod.h"
+#include "BlendTree.h"
+#include "KernelAnimator.h"
+#include "UniformBlockStaging.h"
+#include "RenderQueue.h"
+#include "InstancedModelGroup.h"
+#include "Bounds.h"
+#include "ShadowCache.h"
+#include "PassTimer.h"
+#include "Profiler.h"
 
 using namespace algine;
 
 class ExampleChessContent: public Content, public WindowEventHandler {
-    friend class LampMoveThread;
+public:
+    enum class CullingPass {
+        Color,
+        PointShadow,
+        DirShadow
+    };
+
+    /**
+     * How the point light cubemap is filled:
+     * GeometryShader - geometry shader emits each triangle to all 6 layers;
+     * Instanced - 6 instances, the vertex shader writes gl_Layer
+     * (requires ARB_shader_viewport_layer_array or AMD_vertex_shader_layer);
+     * PerFace - separate pass for each face, casters are culled by the face frustum
+     */
+    enum class PointShadowMode {
+        GeometryShader,
+        Instanced,
+        PerFace
+    };
+
+    /**
+     * How the reflections are traced:
+     * Linear - fixed linear ray march with binary search at the full resolution;
+     * HiZ - hierarchical traversal of the min-depth pyramid (see <code>HiZPyramid</code>);
+     * HiZHalf - the same at the half resolution, bilaterally upsampled
+     */
+    enum class SSRMode {
+        Linear,
+        HiZ,
+        HiZHalf
+    };
 
 public:
     ~ExampleChessContent() override;
@@ -42,6 +93,61 @@ public:
 
     void windowSizeChange(int width, int height, Window &window) override;
 
+    void setPassTimer(PassTimer *timer);
+    void setTimeOverride(float seconds);
+
+    /**
+     * Must be called before <code>init</code>. If <code>Instanced</code>
+     * is not supported, <code>PerFace</code> is used instead
+     */
+    void setPointShadowMode(PointShadowMode mode);
+    PointShadowMode getPointShadowMode() const;
+
+    static const char* getPointShadowModeName(PointShadowMode mode);
+
+    /**
+     * Must be called before <code>init</code>.
+     * Skinned models are skinned once per frame, see <code>PreSkinning</code>
+     */
+    void setPreSkinningEnabled(bool enabled);
+    bool isPreSkinningEnabled() const;
+
+    /**
+     * Must be called before <code>init</code>. G-buffer stores octahedral
+     * normals (RG16) and no positions: SSR and CoC reconstruct them from depth
+     */
+    void setCompactGBufferEnabled(bool enabled);
+    bool isCompactGBufferEnabled() const;
+
+    /**
+     * Must be called before <code>init</code>
+     */
+    void setSSRMode(SSRMode mode);
+    SSRMode getSSRMode() const;
+
+    static const char* getSSRModeName(SSRMode mode);
+
+    /**
+     * Must be called before <code>init</code>. DualKawase is used only by the blurs with
+     * radius from <code>kawaseMinRadius</code>, the others use Linear instead.
+     * If compute shaders are not supported, Linear is used
+     */
+    void setBlurMode(GaussianBlur::Mode mode);
+    GaussianBlur::Mode getBlurMode() const;
+
+    /**
+     * @return texture fetches per pixel of the bloom, CoC and DOF blurs
+     */
+    float getBlurFetchesPerPixel() const;
+
+    Camera& getCamera();
+    Profiler& getProfiler();
+    const RenderQueue& getRenderQueue() const;
+    const CullingStats& getCullingStats(CullingPass pass) const;
+    const ShadowCacheStats& getShadowCacheStats() const;
+    const AnimationLod::Stats& getAnimationLodStats() const;
+    const RenderTargetPool::Stats& getRenderTargetStats() const;
+
 private:
     void resize();
     void pollKeys();
@@ -55,44 +161,104 @@ private:
     void initLamps();
     void initShadowMaps();
     void initDOF();
+    void initAnimationJobs();
+    void setManBlendFactor(float factor);
+    void animateMan(float time);
 
+    void updateSimulation();
     void sendLampsData();
 
-    glm::mat4 getMVPMatrix(const glm::mat4 &modelMatrix);
-    glm::mat4 getMVMatrix(const glm::mat4 &modelMatrix);
     void updateMatrices(const glm::mat4 &modelMatrix);
 
-    void drawModelDM(ModelPtr &model, ShaderProgramPtr &program, const glm::mat4 &mat = glm::mat4(1.0f));
-    void drawModel(ModelPtr &model);
+    using VolumeTest = std::function<bool(const AABB&)>;
+
+    void computeBounds(const ShapePtr &shape);
+    const ShapeBounds& getBounds(const ShapePtr &shape) const;
+
+    void drawModelDM(ModelPtr &model, UniformCache &uniforms, const VolumeTest &isVisible,
+                     CullingStats &stats, const glm::mat4 &mat = glm::mat4(1.0f), uint instancesCount = 1);
+    void drawGroupDM(InstancedModelGroup &group, UniformCache &uniforms, const VolumeTest &isVisible,
+                     CullingStats &stats, const ModelPtr &exclude, const glm::mat4 &mat = glm::mat4(1.0f),
+                     uint repeat = 1);
+    void queueModel(const ModelPtr &model, const Frustum &frustum);
+    void queueGroup(InstancedModelGroup &group, const Frustum &frustum);
+    VolumeTest getPointLightVolume(uint index) const;
+    VolumeTest getDirLightVolume(uint index) const;
+    void addShadowCasters(ShadowCache &cache, const VolumeTest &isVisible, const ModelPtr &model);
+    bool isPointShadowDirty(uint index);
+    bool isDirShadowDirty(uint index);
     void renderToDepthCubemap(uint index);
+    void drawPointShadowCasters(uint index, const VolumeTest &isVisible, uint instancesCount = 1);
     void renderToDepthMap(uint index);
 
     void renderScene();
 
+    float getTime() const;
+
+    void beginPass(PassTimer::Pass pass);
+    void endPass(PassTimer::Pass pass);
+
 private:
     std::vector<ShapePtr> shapes;
     std::vector<ModelPtr> models, lamps;
-    AnimationBlender manAnimationBlender;
+    std::unordered_map<const Shape*, ShapeBounds> shapeBounds;
+    BlendTree manBlendTree;
+    KernelAnimator manAnimator; // clips of the blend tree are sampled by the SoA kernels
+    BlendTree::Node manBlend = BlendTree::None;
+    float manBlendFactor = 0.0f;
+    BonesStorage manBones;
     BoneSystemManager boneManager;
 
+private:
+    JobSystem jobSystem;
+    AssetLoader assetLoader {jobSystem};
+    ProgramCache programCache;
+    JobGraph animationJobs;
+    float animationTime = 0.0f;
+    uint64_t bonesVersion = 0; // changed every time when bones of any model may have changed
+    AnimationLod animationLod;
+
+    bool preSkinningEnabled = false;
+    PreSkinning preSkinning;
+    uint64_t preSkinnedBonesVersion = UINT64_MAX;
+
 private:
     std::vector<PointLamp> pointLamps;
     std::vector<DirLamp> dirLamps;
+    InstancedModelGroup lampsGroup;
     LampMoveThread lampThread;
     LightingManager lightManager;
+    UniformBlockStaging lightingBlock;
+    std::vector<UniformBlockStaging::Location> pointLampPosLocations, dirLampPosLocations;
 
 private:
     CubeRendererPtr skyboxRenderer;
     QuadRendererPtr quadRenderer;
+    RenderQueue renderQueue;
+
+private:
+    CullingStats colorCulling;
+    CullingStats pointShadowCulling;
+    CullingStats dirShadowCulling;
 
 private:
-    Ptr<Blur> bloomBlur;
-    Ptr<Blur> dofBlur;
-    Ptr<Blur> cocBlur;
+    std::vector<ShadowCache> pointShadowCaches;
+    std::vector<ShadowCache> dirShadowCaches;
+    ShadowCacheStats shadowCacheStats;
+
+private:
+    GaussianBlur::Mode blurMode = GaussianBlur::Mode::PingPong;
+    GaussianBlur::Programs blurPrograms;
+    Ptr<GaussianBlur> bloomBlur;
+    Ptr<GaussianBlur> dofBlur;
+    Ptr<GaussianBlur> cocBlur;
+
+private:
+    RenderTargetPool targetPool;
 
 private:
     FramebufferPtr displayFb;
-    FramebufferPtr screenspaceFb;
+    FramebufferPtr screenspaceFb; // from the pool
     FramebufferPtr bloomSearchFb;
     FramebufferPtr cocFb;
 
@@ -100,7 +266,8 @@ private:
     Texture2DPtr colorTex;
     Texture2DPtr normalTex;
     Texture2DPtr ssrValues;
-    Texture2DPtr positionTex;
+    Texture2DPtr positionTex; // nullptr in the compact mode
+    Texture2DPtr depthTex;
     Texture2DPtr screenspaceTex;
     Texture2DPtr bloomTex;
     Texture2DPtr cocTex;
@@ -111,10 +278,26 @@ private:
     ShaderProgramPtr colorShader;
     ShaderProgramPtr pointShadowShader;
     ShaderProgramPtr dirShadowShader;
+    PointShadowMode pointShadowMode = PointShadowMode::GeometryShader;
+    bool compactGBuffer = false;
     ShaderProgramPtr dofCoCShader;
     ShaderProgramPtr ssrShader;
+    SSRMode ssrMode = SSRMode::Linear;
+    HiZPyramid hiZ; // Hi-Z modes only
+    ShaderProgramPtr hiZShader;
+    ShaderProgramPtr ssrResolveShader;
+    FramebufferPtr ssrHitFb;
+    Texture2DPtr ssrHitTex;
     ShaderProgramPtr bloomSearchShader;
     ShaderProgramPtr blendShader;
+    ShaderProgramPtr skinningShader;
+
+    // uniforms which are changed every frame or draw
+    UniformCache colorUniforms;
+    UniformCache pointShadowUniforms;
+    UniformCache dirShadowUniforms;
+
+    FrameUniforms frameUniforms;
 
 private:
     Camera camera;
@@ -122,6 +305,11 @@ private:
 
 private:
     EulerRotator manHeadRotator;
+
+private:
+    PassTimer *passTimer = nullptr;
+    Profiler profiler;
+    float timeOverride = -1.0f;
 };
 
 #endif //ALGINE_EXAMPLES_EXAMPLECHESSCONTENT_H
@@ -0,0 +1,90 @@
+#include "FrameUniforms.h"
+
+#include <algine/core/shader/ShaderProgram.h>
+#include <algine/gl.h>
+
+#include <glm/gtc/matrix_inverse.hpp>
+
+#include <iostream>
+
+using namespace std;
+
+static_assert(sizeof(FrameUniforms::Data) == 6 * 64 + 2 * 16 + 16, "Data must match the std140 layout");
+
+constexpr static char BlockName[] = "Frame";
+
+FrameUniforms::FrameUniforms()
+    : m_bindingPoint(0),
+      m_buffer(0),
+      m_data() {}
+
+FrameUniforms::~FrameUniforms() {
+    if (m_buffer != 0) {
+        glDeleteBuffers(1, &m_buffer);
+    }
+}
+
+void FrameUniforms::setBindingPoint(uint bindingPoint) {
+    m_bindingPoint = bindingPoint;
+}
+
+uint FrameUniforms::getBindingPoint() const {
+    return m_bindingPoint;
+}
+
+void FrameUniforms::setShaderPrograms(const vector<ShaderProgramPtr> &programs) {
+    for (auto &program : programs) {
+        auto id = program->getId();
+        auto index = glGetUniformBlockIndex(id, BlockName);
+
+        if (index == GL_INVALID_INDEX)
+            continue; // the block is unused by the program
+
+        GLint size;
+        glGetActiveUniformBlockiv(id, index, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+
+        if (size != sizeof(Data))
+            cerr << "FrameUniforms: unexpected block size " << size << ", " << sizeof(Data) << " expected\n";
+
+        glUniformBlockBinding(id, index, m_bindingPoint);
+    }
+}
+
+void FrameUniforms::init() {
+    if (m_buffer == 0)
+        glGenBuffers(1, &m_buffer);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, sizeof(Data), &m_data, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, m_bindingPoint, m_buffer);
+}
+
+void FrameUniforms::update(const glm::mat4 &view, const glm::mat4 &projection,
+                           uint width, uint height, float time)
+{
+    m_data.view = view;
+    m_data.projection = projection;
+    m_data.viewProjection = projection * view;
+    m_data.invView = glm::affineInverse(view);
+    m_data.invProjection = glm::inverse(projection);
+    m_data.invViewProjection = m_data.invView * m_data.invProjection;
+    m_data.cameraPos = m_data.invView[3];
+    auto w = static_cast<float>(width);
+    auto h = static_cast<float>(height);
+
+    m_data.viewport = glm::vec4(w, h, 1.0f / w, 1.0f / h);
+    m_data.time = time;
+
+    // orphaning, so the draws of the previous frame are not waited
+    // GL_COPY_WRITE_BUFFER is used to not change the uniform buffer bound by the engine
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, sizeof(Data), nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, 0, sizeof(Data), &m_data);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+const FrameUniforms::Data& FrameUniforms::getData() const {
+    return m_data;
+}
@@ -0,0 +1,67 @@
+#ifndef ALGINE_EXAMPLES_FRAMEUNIFORMS_H
+#define ALGINE_EXAMPLES_FRAMEUNIFORMS_H
+
+#include <algine/core/shader/ShaderProgramPtr.h>
+#include <algine/types.h>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include <vector>
+
+using namespace algine;
+
+/**
+ * Per-frame camera and scene values shared by all programs through
+ * the <code>Frame</code> uniform block (see shaders/Frame.glsl).
+ * Written once per frame and bound to the fixed binding point,
+ * like the lighting and bones blocks
+ */
+class FrameUniforms {
+public:
+    // std140 layout of the block
+    struct Data {
+        glm::mat4 view;
+        glm::mat4 projection;
+        glm::mat4 viewProjection;
+        glm::mat4 invView;
+        glm::mat4 invProjection;
+        glm::mat4 invViewProjection;
+        glm::vec4 cameraPos; // w is unused
+        glm::vec4 viewport; // width, height, 1 / width, 1 / height
+        float time;
+        float padding[3];
+    };
+
+public:
+    FrameUniforms();
+    ~FrameUniforms();
+
+    FrameUniforms(const FrameUniforms&) = delete;
+    FrameUniforms& operator=(const FrameUniforms&) = delete;
+
+    void setBindingPoint(uint bindingPoint);
+    uint getBindingPoint() const;
+
+    /**
+     * Assigns the binding point to the <code>Frame</code> blocks of the programs
+     */
+    void setShaderPrograms(const std::vector<ShaderProgramPtr> &programs);
+
+    void init();
+
+    /**
+     * Computes the derived values and uploads the block
+     */
+    void update(const glm::mat4 &view, const glm::mat4 &projection,
+                uint width, uint height, float time);
+
+    const Data& getData() const;
+
+private:
+    uint m_bindingPoint;
+    uint m_buffer;
+    Data m_data;
+};
+
+#endif //ALGINE_EXAMPLES_FRAMEUNIFORMS_H
@@ -0,0 +1,24 @@
+#include "GLExtensions.h"
+
+#include <algine/gl.h>
+
+#include <unordered_set>
+#include <string>
+
+using namespace std;
+
+bool isExtensionSupported(const char *name) {
+    static const unordered_set<string> extensions = []() {
+        unordered_set<string> result;
+
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+        for (GLint i = 0; i < count; i++)
+            result.emplace(reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i)));
+
+        return result;
+    }();
+
+    return extensions.count(name) != 0;
+}
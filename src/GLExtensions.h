@@ -0,0 +1,11 @@
+#ifndef ALGINE_EXAMPLES_GLEXTENSIONS_H
+#define ALGINE_EXAMPLES_GLEXTENSIONS_H
+
+/**
+ * @param name e.g. <code>GL_ARB_buffer_storage</code>
+ * @return true if the extension is supported by the current context.
+ * Extensions are queried once, on the first call, which needs the context
+ */
+bool isExtensionSupported(const char *name);
+
+#endif //ALGINE_EXAMPLES_GLEXTENSIONS_H
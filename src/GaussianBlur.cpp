@@ -0,0 +1,339 @@
+#include "GaussianBlur.h"
+#include "BlurShader.h"
+
+#include <algine/core/framebuffer/Framebuffer.h>
+#include <algine/core/shader/ShaderProgram.h>
+#include <algine/core/texture/Texture2D.h>
+#include <algine/std/QuadRenderer.h>
+#include <algine/core/Engine.h>
+#include <algine/core/PtrMaker.h>
+#include <algine/gl.h>
+
+#include <glm/vec2.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <cmath>
+
+using namespace std;
+
+// work group size of BlurCompute.comp.glsl
+constexpr static uint ComputeTileSize = 128;
+
+GaussianBlur::GaussianBlur(Mode mode, const TextureCreateInfo &createInfo)
+    : m_mode(mode),
+      m_createInfo(createInfo),
+      m_pool(nullptr),
+      m_poolScale(1.0f),
+      m_radius(0),
+      m_kawaseLevels(0) {}
+
+void GaussianBlur::setPrograms(const Programs &programs) {
+    m_programs = programs;
+}
+
+void GaussianBlur::setQuadRenderer(const QuadRendererPtr &quadRenderer) {
+    m_quadRenderer = quadRenderer;
+
+    if (m_blur) {
+        m_blur->setQuadRenderer(quadRenderer);
+    }
+}
+
+void GaussianBlur::setTargetPool(RenderTargetPool *pool, const string &name, float scale) {
+    m_pool = pool;
+    m_poolName = name;
+    m_poolScale = scale;
+}
+
+void GaussianBlur::declarePasses(RenderTargetPool::Target input) {
+    if (!m_pool)
+        return;
+
+    auto &targets = m_poolTargets;
+
+    switch (m_mode) {
+        case Mode::PingPong: m_pool->addPass(m_poolName, {input}, {}); break;
+        case Mode::Linear:
+        case Mode::Compute: {
+            m_pool->addPass(m_poolName + ".h", {input}, {targets[0]});
+            m_pool->addPass(m_poolName + ".v", {targets[0]}, {targets[1]});
+            break;
+        }
+        case Mode::DualKawase: {
+            for (uint level = 1; level <= m_kawaseLevels; level++)
+                m_pool->addPass(m_poolName + ".down" + to_string(level), {level == 1 ? input : targets[level - 1]}, {targets[level]});
+
+            for (uint level = m_kawaseLevels; level > 0; level--)
+                m_pool->addPass(m_poolName + ".up" + to_string(level - 1), {targets[level]}, {targets[level - 1]});
+
+            break;
+        }
+    }
+}
+
+RenderTargetPool::Target GaussianBlur::getOutputTarget() const {
+    return m_poolTargets.empty() ? RenderTargetPool::None : m_poolTargets[getOutputIndex()];
+}
+
+void GaussianBlur::configureKernel(uint radius, float sigma, const string &channels) {
+    if (radius > MaxRadius) {
+        cerr << "GaussianBlur: radius " << radius << " is clamped to " << MaxRadius << "\n";
+        radius = MaxRadius;
+    }
+
+    m_radius = radius;
+
+    // normalized over [-radius, radius]
+    m_weights.resize(radius + 1);
+
+    float sum = 0.0f;
+
+    for (uint i = 0; i <= radius; i++) {
+        m_weights[i] = exp(-static_cast<float>(i * i) / (2.0f * sigma * sigma));
+        sum += i == 0 ? m_weights[i] : 2.0f * m_weights[i];
+    }
+
+    for (auto &weight : m_weights)
+        weight /= sum;
+
+    // taps i and i + 1 are fetched at once, between them in proportion to their weights
+    m_linearOffsets = {0.0f};
+    m_linearWeights = {m_weights[0]};
+
+    for (uint i = 1; i <= radius; i += 2) {
+        float w0 = m_weights[i];
+        float w1 = i + 1 <= radius ? m_weights[i + 1] : 0.0f;
+
+        m_linearOffsets.emplace_back((static_cast<float>(i) * w0 + static_cast<float>(i + 1) * w1) / (w0 + w1));
+        m_linearWeights.emplace_back(w0 + w1);
+    }
+
+    // each level doubles the radius, the first one covers about 4 texels
+    m_kawaseLevels = static_cast<uint>(max(1.0f, round(log2(static_cast<float>(max(radius, 2u)))) - 1.0f));
+    m_kawaseLevels = min(m_kawaseLevels, MaxKawaseLevels);
+
+    switch (m_mode) {
+        case Mode::PingPong: {
+            m_blur = PtrMaker::make<Blur>(m_createInfo);
+            m_blur->setPingPongShaders(Blur::getPingPongShaders(radius, channels));
+            m_blur->setQuadRenderer(m_quadRenderer);
+            m_blur->configureKernel(radius, sigma);
+            break;
+        }
+        case Mode::Linear: createTargets(2, m_createInfo.format); break;
+        case Mode::Compute: createTargets(2, GL_RGBA16F); break; // RGB16F can't be an image
+        case Mode::DualKawase: createTargets(m_kawaseLevels + 1, m_createInfo.format); break;
+    }
+}
+
+void GaussianBlur::makeBlur(Texture2D *image) {
+    switch (m_mode) {
+        case Mode::PingPong: m_blur->makeBlur(image); break;
+        case Mode::Linear: makeLinearBlur(image); break;
+        case Mode::Compute: makeComputeBlur(image); break;
+        case Mode::DualKawase: makeKawaseBlur(image); break;
+    }
+}
+
+void GaussianBlur::resizeOutput(uint width, uint height) {
+    m_createInfo.width = width;
+    m_createInfo.height = height;
+
+    if (m_blur) {
+        m_blur->resizeOutput(width, height);
+        return;
+    }
+
+    if (m_pool)
+        return;
+
+    // DualKawase: level i is 2^i times smaller
+    for (uint i = 0; i < m_framebuffers.size(); i++) {
+        uint level = m_mode == Mode::DualKawase ? i : 0;
+        m_framebuffers[i]->resizeAttachments(getWidth(level), getHeight(level));
+    }
+}
+
+Texture2DPtr GaussianBlur::get() const {
+    if (m_blur)
+        return m_blur->get();
+
+    return getTexture(getOutputIndex());
+}
+
+GaussianBlur::Mode GaussianBlur::getMode() const {
+    return m_mode;
+}
+
+float GaussianBlur::getFetchesPerPixel() const {
+    auto radius = static_cast<float>(m_radius);
+
+    switch (m_mode) {
+        case Mode::PingPong: return 2.0f * (2.0f * radius + 1.0f);
+        case Mode::Linear: return 2.0f * (2.0f * static_cast<float>(m_linearWeights.size()) - 1.0f);
+        case Mode::Compute: return 2.0f * (ComputeTileSize + 2.0f * radius) / ComputeTileSize; // from the texture
+        case Mode::DualKawase: {
+            float fetches = 0.0f;
+            float area = 1.0f;
+
+            for (uint level = 1; level <= m_kawaseLevels; level++) {
+                fetches += 8.0f * area; // upsample to level - 1
+                area *= 0.25f;
+                fetches += 5.0f * area; // downsample to level
+            }
+
+            return fetches;
+        }
+    }
+
+    return 0.0f;
+}
+
+const char* GaussianBlur::getModeName(Mode mode) {
+    switch (mode) {
+        case Mode::Linear: return "linear";
+        case Mode::Compute: return "compute";
+        case Mode::DualKawase: return "kawase";
+        default: return "pingpong";
+    }
+}
+
+void GaussianBlur::createTargets(uint count, uint format) {
+    if (m_pool) {
+        createPoolTargets(count, format);
+        return;
+    }
+
+    m_textures.resize(count);
+    m_framebuffers.resize(count);
+
+    for (uint i = 0; i < count; i++) {
+        auto &texture = m_textures[i];
+        auto &framebuffer = m_framebuffers[i];
+
+        PtrMaker::create(texture, framebuffer);
+
+        texture->setFormat(format);
+        texture->setParams(m_createInfo.params);
+
+        framebuffer->bind();
+        framebuffer->attachTexture(texture, Framebuffer::ColorAttachmentZero);
+    }
+
+    if (!m_framebuffers.empty())
+        m_framebuffers.back()->unbind();
+
+    resizeOutput(m_createInfo.width, m_createInfo.height);
+}
+
+void GaussianBlur::createPoolTargets(uint count, uint format) {
+    m_poolTargets.resize(count);
+
+    // DualKawase: level i is 2^i times smaller
+    for (uint i = 0; i < count; i++) {
+        float scale = m_mode == Mode::DualKawase ? m_poolScale / static_cast<float>(1u << i) : m_poolScale;
+        m_poolTargets[i] = m_pool->create(m_poolName + "." + to_string(i), format, scale);
+    }
+}
+
+void GaussianBlur::makeLinearBlur(Texture2D *image) {
+    auto &program = m_programs.linear;
+    auto id = program->getId();
+    auto count = static_cast<GLsizei>(m_linearWeights.size());
+
+    // the program is shared, so the kernel is set each time
+    program->bind();
+    program->setInt(BlurShader::Vars::TapsCount, count);
+    glUniform1fv(glGetUniformLocation(id, BlurShader::Vars::Offsets), count, m_linearOffsets.data());
+    glUniform1fv(glGetUniformLocation(id, BlurShader::Vars::Weights), count, m_linearWeights.data());
+
+    Engine::setViewport(getWidth(0), getHeight(0));
+
+    getFramebuffer(0)->bind();
+    image->use(0);
+    program->setVec2(BlurShader::Vars::Direction, glm::vec2(1.0f, 0.0f));
+    m_quadRenderer->draw();
+
+    getFramebuffer(1)->bind();
+    getTexture(0)->use(0);
+    program->setVec2(BlurShader::Vars::Direction, glm::vec2(0.0f, 1.0f));
+    m_quadRenderer->draw();
+
+    program->unbind();
+}
+
+void GaussianBlur::makeComputeBlur(Texture2D *image) {
+    auto &program = m_programs.compute;
+    auto width = getWidth(0);
+    auto height = getHeight(0);
+
+    program->bind();
+    program->setInt(BlurShader::Vars::Radius, static_cast<int>(m_radius));
+    glUniform1fv(glGetUniformLocation(program->getId(), BlurShader::Vars::Weights),
+                 static_cast<GLsizei>(m_weights.size()), m_weights.data());
+
+    auto groups = [](uint length) { return (length + ComputeTileSize - 1) / ComputeTileSize; };
+
+    // a work group per tile of a row, then of a column
+    glBindImageTexture(0, getTexture(0)->getId(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+    image->use(0);
+    program->setVec2(BlurShader::Vars::Direction, glm::vec2(1.0f, 0.0f));
+    glDispatchCompute(groups(width), height, 1);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    glBindImageTexture(0, getTexture(1)->getId(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+    getTexture(0)->use(0);
+    program->setVec2(BlurShader::Vars::Direction, glm::vec2(0.0f, 1.0f));
+    glDispatchCompute(groups(height), width, 1);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    program->unbind();
+}
+
+void GaussianBlur::makeKawaseBlur(Texture2D *image) {
+    auto &program = m_programs.kawase;
+
+    auto draw = [&](uint target, Texture2D *source) {
+        Engine::setViewport(getWidth(target), getHeight(target));
+        getFramebuffer(target)->bind();
+        source->use(0);
+        program->setVec2(BlurShader::Vars::HalfPixel,
+                         glm::vec2(0.5f / static_cast<float>(getWidth(target)), 0.5f / static_cast<float>(getHeight(target))));
+        m_quadRenderer->draw();
+    };
+
+    program->bind();
+    program->setInt(BlurShader::Vars::Upsample, 0);
+
+    for (uint level = 1; level <= m_kawaseLevels; level++)
+        draw(level, level == 1 ? image : getTexture(level - 1).get());
+
+    program->setInt(BlurShader::Vars::Upsample, 1);
+
+    for (uint level = m_kawaseLevels; level > 0; level--)
+        draw(level - 1, getTexture(level).get());
+
+    program->unbind();
+}
+
+const Texture2DPtr& GaussianBlur::getTexture(uint index) const {
+    return m_pool ? m_pool->get(m_poolTargets[index]) : m_textures[index];
+}
+
+const FramebufferPtr& GaussianBlur::getFramebuffer(uint index) const {
+    return m_pool ? m_pool->getFramebuffer(m_poolTargets[index]) : m_framebuffers[index];
+}
+
+uint GaussianBlur::getOutputIndex() const {
+    return m_mode == Mode::DualKawase ? 0 : 1;
+}
+
+// the pool rounds the scaled sizes on its own
+uint GaussianBlur::getWidth(uint level) const {
+    return m_pool ? getTexture(level)->getWidth() : max(m_createInfo.width >> level, 1u);
+}
+
+uint GaussianBlur::getHeight(uint level) const {
+    return m_pool ? getTexture(level)->getHeight() : max(m_createInfo.height >> level, 1u);
+}
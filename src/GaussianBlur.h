@@ -0,0 +1,136 @@
+#ifndef ALGINE_EXAMPLES_GAUSSIANBLUR_H
+#define ALGINE_EXAMPLES_GAUSSIANBLUR_H
+
+#include <algine/core/framebuffer/FramebufferPtr.h>
+#include <algine/core/shader/ShaderProgramPtr.h>
+#include <algine/core/texture/Texture2DPtr.h>
+#include <algine/std/QuadRendererPtr.h>
+#include <algine/std/Blur.h>
+#include <algine/types.h>
+
+#include "RenderTargetPool.h"
+
+#include <string>
+#include <vector>
+
+using namespace algine;
+
+/**
+ * Separable Gaussian blur with the same interface as the engine's <code>Blur</code>
+ * and a backend chosen per instance:
+ * PingPong - the engine's <code>Blur</code>, 2 * radius + 1 fetches per pixel and direction;
+ * Linear - pairs of adjacent taps are merged into one bilinear fetch
+ * between them, radius + 1 fetches (rounded up to odd) for the same kernel;
+ * Compute - each work group loads a line segment with the kernel apron
+ * into shared memory once and convolves it there (GL 4.3);
+ * DualKawase - chain of downsample / upsample passes (5 and 8 bilinear fetches
+ * at the decreasing resolutions), which approximates the large radii in constant cost.
+ * Linear and DualKawase rely on the linear filtering of the blurred image
+ */
+class GaussianBlur {
+public:
+    enum class Mode {
+        PingPong,
+        Linear,
+        Compute,
+        DualKawase
+    };
+
+    /**
+     * Shared by the instances, only the ones used by their modes are required:
+     * BlurLinear, BlurCompute and BlurKawase configs
+     */
+    struct Programs {
+        ShaderProgramPtr linear;
+        ShaderProgramPtr compute;
+        ShaderProgramPtr kawase;
+    };
+
+    static constexpr uint MaxRadius = 32; // must match the shaders
+    static constexpr uint MaxKawaseLevels = 6;
+
+public:
+    GaussianBlur(Mode mode, const TextureCreateInfo &createInfo);
+
+    void setPrograms(const Programs &programs);
+    void setQuadRenderer(const QuadRendererPtr &quadRenderer);
+
+    /**
+     * Must be called before <code>configureKernel</code>. Targets of the modes except
+     * PingPong are created in the pool, at <code>scale</code> of its render size;
+     * the sizes passed to <code>resizeOutput</code> are ignored then
+     */
+    void setTargetPool(RenderTargetPool *pool, const std::string &name, float scale);
+
+    /**
+     * Adds the passes of the blur to the pool, in the order they are executed
+     */
+    void declarePasses(RenderTargetPool::Target input);
+
+    /**
+     * @return <code>RenderTargetPool::None</code> if the output isn't in the pool
+     */
+    RenderTargetPool::Target getOutputTarget() const;
+
+    /**
+     * @param channels of the engine's ping-pong shaders, "rgb" or "r"
+     */
+    void configureKernel(uint radius, float sigma, const std::string &channels = "rgb");
+
+    /**
+     * Changes the bound framebuffer and the viewport
+     */
+    void makeBlur(Texture2D *image);
+
+    void resizeOutput(uint width, uint height);
+
+    Texture2DPtr get() const;
+
+    Mode getMode() const;
+
+    /**
+     * @return texture fetches per output pixel, all passes
+     */
+    float getFetchesPerPixel() const;
+
+    static const char* getModeName(Mode mode);
+
+private:
+    void createTargets(uint count, uint format);
+    void createPoolTargets(uint count, uint format);
+    void makeLinearBlur(Texture2D *image);
+    void makeComputeBlur(Texture2D *image);
+    void makeKawaseBlur(Texture2D *image);
+
+    const Texture2DPtr& getTexture(uint index) const;
+    const FramebufferPtr& getFramebuffer(uint index) const;
+    uint getOutputIndex() const;
+
+    uint getWidth(uint level) const;
+    uint getHeight(uint level) const;
+
+private:
+    Mode m_mode;
+    TextureCreateInfo m_createInfo;
+    Programs m_programs;
+    QuadRendererPtr m_quadRenderer;
+    Ptr<Blur> m_blur; // PingPong
+
+    // Linear and Compute: horizontal pass result and the output;
+    // DualKawase: the output and the downsampled levels
+    std::vector<Texture2DPtr> m_textures;
+    std::vector<FramebufferPtr> m_framebuffers;
+
+    // the same, in the pool if it's set
+    RenderTargetPool *m_pool;
+    std::string m_poolName;
+    float m_poolScale;
+    std::vector<RenderTargetPool::Target> m_poolTargets;
+
+    uint m_radius;
+    std::vector<float> m_weights; // Gaussian, from the center
+    std::vector<float> m_linearOffsets, m_linearWeights; // merged taps
+    uint m_kawaseLevels;
+};
+
+#endif //ALGINE_EXAMPLES_GAUSSIANBLUR_H
@@ -0,0 +1,120 @@
+#include "HiZPyramid.h"
+
+#include <algine/core/shader/ShaderProgram.h>
+#include <algine/core/texture/Texture2D.h>
+#include <algine/std/QuadRenderer.h>
+#include <algine/core/Engine.h>
+#include <algine/gl.h>
+
+#include <algorithm>
+
+using namespace std;
+
+constexpr static char SrcMap[] = "srcMap";
+constexpr static char Downsample[] = "downsample";
+
+HiZPyramid::HiZPyramid()
+    : m_texture(0),
+      m_framebuffer(0),
+      m_width(0),
+      m_height(0),
+      m_levels(0) {}
+
+HiZPyramid::~HiZPyramid() {
+    if (m_texture != 0) {
+        glDeleteTextures(1, &m_texture);
+    }
+
+    if (m_framebuffer != 0) {
+        glDeleteFramebuffers(1, &m_framebuffer);
+    }
+}
+
+void HiZPyramid::setProgram(const ShaderProgramPtr &program) {
+    m_program = program;
+    m_program->bind();
+    m_program->setInt(SrcMap, 0);
+    m_program->unbind();
+}
+
+void HiZPyramid::resize(uint width, uint height) {
+    width = max(width, 1u);
+    height = max(height, 1u);
+
+    if (width == m_width && height == m_height)
+        return;
+
+    m_width = width;
+    m_height = height;
+    m_levels = 1;
+
+    while ((max(width, height) >> m_levels) > 0)
+        ++m_levels;
+
+    if (m_framebuffer == 0)
+        glGenFramebuffers(1, &m_framebuffer);
+
+    // levels are created one by one, so sizes can change without the immutable storage
+    if (m_texture == 0)
+        glGenTextures(1, &m_texture);
+
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+
+    for (uint level = 0; level < m_levels; level++) {
+        auto w = static_cast<GLsizei>(max(width >> level, 1u));
+        auto h = static_cast<GLsizei>(max(height >> level, 1u));
+        glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), GL_R32F, w, h, 0, GL_RED, GL_FLOAT, nullptr);
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(m_levels - 1));
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void HiZPyramid::build(const Texture2DPtr &depth, const QuadRendererPtr &quad) {
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    m_program->bind();
+
+    for (uint level = 0; level < m_levels; level++) {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_texture, static_cast<GLint>(level));
+        Engine::setViewport(max(m_width >> level, 1u), max(m_height >> level, 1u));
+
+        if (level == 0) {
+            depth->use(0);
+            m_program->setInt(Downsample, 0);
+        } else {
+            // the previous level becomes the only one, so it's read while the next is written
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, m_texture);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(level - 1));
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(level - 1));
+            m_program->setInt(Downsample, 1);
+        }
+
+        quad->draw();
+    }
+
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(m_levels - 1));
+
+    m_program->unbind();
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void HiZPyramid::use(uint slot) const {
+    glActiveTexture(GL_TEXTURE0 + slot);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+}
+
+uint HiZPyramid::getLevelsCount() const {
+    return m_levels;
+}
+
+uint HiZPyramid::getId() const {
+    return m_texture;
+}
@@ -0,0 +1,52 @@
+#ifndef ALGINE_EXAMPLES_HIZPYRAMID_H
+#define ALGINE_EXAMPLES_HIZPYRAMID_H
+
+#include <algine/core/shader/ShaderProgramPtr.h>
+#include <algine/core/texture/Texture2DPtr.h>
+#include <algine/std/QuadRendererPtr.h>
+#include <algine/types.h>
+
+using namespace algine;
+
+/**
+ * Hierarchical-Z pyramid: R32F mip chain, which level 0 is a copy of the depth buffer
+ * and each next level stores the min depth of 2x2 (3x3 on the odd edges) texels of
+ * the previous one, see shaders/HiZBuild.frag.glsl.
+ * Levels are rendered by a separate pass each, reading the previous level,
+ * which is the only level visible to the sampler at this time
+ */
+class HiZPyramid {
+public:
+    HiZPyramid();
+    ~HiZPyramid();
+
+    HiZPyramid(const HiZPyramid&) = delete;
+    HiZPyramid& operator=(const HiZPyramid&) = delete;
+
+    void setProgram(const ShaderProgramPtr &program);
+
+    /**
+     * (Re)allocates the levels down to 1x1
+     */
+    void resize(uint width, uint height);
+
+    /**
+     * Changes the bound framebuffer, viewport and texture unit 0.
+     * The quad input layout must be bound
+     */
+    void build(const Texture2DPtr &depth, const QuadRendererPtr &quad);
+
+    void use(uint slot) const;
+
+    uint getLevelsCount() const;
+    uint getId() const;
+
+private:
+    ShaderProgramPtr m_program;
+    uint m_texture;
+    uint m_framebuffer;
+    uint m_width, m_height;
+    uint m_levels;
+};
+
+#endif //ALGINE_EXAMPLES_HIZPYRAMID_H
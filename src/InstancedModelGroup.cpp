@@ -0,0 +1,125 @@
+#include "InstancedModelGroup.h"
+
+#include <algine/std/model/Shape.h>
+#include <algine/std/model/Model.h>
+#include <algine/gl.h>
+
+#include <algorithm>
+
+using namespace std;
+
+void InstancedModelGroup::resetInstanceMatrix() {
+    for (uint i = 0; i < 4; i++) {
+        glm::vec4 column(0.0f);
+        column[i] = 1.0f;
+
+        glVertexAttrib4f(InstanceMatrixLocation + i, column.x, column.y, column.z, column.w);
+    }
+}
+
+InstancedModelGroup::InstancedModelGroup()
+    : m_buffer(0),
+      m_capacity(0),
+      m_boundLayout(0) {}
+
+InstancedModelGroup::~InstancedModelGroup() {
+    if (m_buffer != 0) {
+        glDeleteBuffers(1, &m_buffer);
+    }
+}
+
+void InstancedModelGroup::setShape(const ShapePtr &shape, uint layoutsCount) {
+    m_shape = shape;
+
+    if (m_buffer == 0)
+        glGenBuffers(1, &m_buffer);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+
+    // attach the instance buffer to all input layouts of the shape
+    for (uint layout = 0; layout < layoutsCount; layout++) {
+        m_shape->getInputLayout(layout)->bind();
+
+        for (uint i = 0; i < 4; i++) {
+            auto location = InstanceMatrixLocation + i;
+            auto offset = reinterpret_cast<void*>(i * sizeof(glm::vec4));
+
+            glEnableVertexAttribArray(location);
+            glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), offset);
+            glVertexAttribDivisor(location, 1);
+        }
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    m_divisors.assign(layoutsCount, 1);
+}
+
+void InstancedModelGroup::addModel(const ModelPtr &model) {
+    m_models.emplace_back(model);
+}
+
+void InstancedModelGroup::removeModel(const ModelPtr &model) {
+    m_models.erase(std::remove(m_models.begin(), m_models.end(), model), m_models.end());
+}
+
+uint InstancedModelGroup::update(const ModelTest &test) {
+    m_matrices.clear();
+
+    for (auto &model : m_models) {
+        if (test(model)) {
+            m_matrices.emplace_back(model->transformation());
+        }
+    }
+
+    if (m_matrices.empty())
+        return 0;
+
+    auto size = static_cast<GLsizeiptr>(m_matrices.size() * sizeof(glm::mat4));
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+
+    // the buffer is updated several times per frame (once per pass),
+    // so it is orphaned to not wait for the previous draws
+    m_capacity = max(m_capacity, static_cast<uint>(m_models.size()));
+    glBufferData(GL_ARRAY_BUFFER, m_capacity * sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size, m_matrices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return static_cast<uint>(m_matrices.size());
+}
+
+void InstancedModelGroup::bind(uint layoutIndex) {
+    m_shape->getInputLayout(layoutIndex)->bind();
+    m_boundLayout = layoutIndex;
+}
+
+void InstancedModelGroup::drawElements(uint start, uint count, uint repeat) {
+    if (m_matrices.empty())
+        return;
+
+    // each instance matrix is used by repeat consecutive instances
+    if (m_divisors[m_boundLayout] != repeat) {
+        for (uint i = 0; i < 4; i++)
+            glVertexAttribDivisor(InstanceMatrixLocation + i, repeat);
+
+        m_divisors[m_boundLayout] = repeat;
+    }
+
+    auto offset = reinterpret_cast<void*>(static_cast<uintptr_t>(start) * sizeof(uint));
+    auto instances = static_cast<GLsizei>(m_matrices.size() * repeat);
+
+    glDrawElementsInstanced(GL_TRIANGLES, count, GL_UNSIGNED_INT, offset, instances);
+}
+
+const ShapePtr& InstancedModelGroup::getShape() const {
+    return m_shape;
+}
+
+const vector<ModelPtr>& InstancedModelGroup::getModels() const {
+    return m_models;
+}
+
+uint InstancedModelGroup::getInstancesCount() const {
+    return static_cast<uint>(m_matrices.size());
+}
@@ -0,0 +1,83 @@
+#ifndef ALGINE_EXAMPLES_INSTANCEDMODELGROUP_H
+#define ALGINE_EXAMPLES_INSTANCEDMODELGROUP_H
+
+#include <algine/std/model/ShapePtr.h>
+#include <algine/std/model/ModelPtr.h>
+#include <algine/types.h>
+
+#include <glm/mat4x4.hpp>
+
+#include <functional>
+#include <vector>
+
+using namespace algine;
+
+/**
+ * Models sharing the same shape, drawn by one instanced draw call per mesh.
+ * Transformations of the models are packed into the instance buffer, which
+ * is attached to all input layouts of the shape at
+ * <code>InstanceMatrixLocation</code> (<code>inInstanceMatrix</code> in the shaders).
+ * Shape of the group must not be drawn without the group.
+ * Models of the group must not have bones
+ */
+class InstancedModelGroup {
+public:
+    constexpr static uint InstanceMatrixLocation = 12; // occupies 4 locations
+
+    using ModelTest = std::function<bool(const ModelPtr&)>;
+
+public:
+    /**
+     * Sets generic value of <code>inInstanceMatrix</code> to the identity,
+     * so non-instanced draws use the model matrix only.
+     * Must be called once after context creation
+     */
+    static void resetInstanceMatrix();
+
+public:
+    InstancedModelGroup();
+    ~InstancedModelGroup();
+
+    InstancedModelGroup(const InstancedModelGroup&) = delete;
+    InstancedModelGroup& operator=(const InstancedModelGroup&) = delete;
+
+    /**
+     * @param layoutsCount amount of the shape's input layouts
+     */
+    void setShape(const ShapePtr &shape, uint layoutsCount);
+
+    void addModel(const ModelPtr &model);
+    void removeModel(const ModelPtr &model);
+
+    /**
+     * Packs transformations of the models that passed <code>test</code>
+     * @return amount of the packed instances
+     */
+    uint update(const ModelTest &test);
+
+    /**
+     * Binds the input layout of the shape
+     */
+    void bind(uint layoutIndex);
+
+    /**
+     * Draws the packed instances, each one <code>repeat</code> times
+     * (e.g. once per cube map face). Input layout must be bound by <code>bind</code>
+     */
+    void drawElements(uint start, uint count, uint repeat = 1);
+
+    const ShapePtr& getShape() const;
+    const std::vector<ModelPtr>& getModels() const;
+    uint getInstancesCount() const;
+
+private:
+    ShapePtr m_shape;
+    std::vector<ModelPtr> m_models;
+    std::vector<glm::mat4> m_matrices;
+    std::vector<uint> m_divisors; // current divisor of each input layout
+    uint m_buffer;
+    uint m_capacity;
+    uint m_boundLayout;
+};
+
+#endif //ALGINE_EXAMPLES_INSTANCEDMODELGROUP_H
@@ -0,0 +1,223 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+
+using namespace std;
+
+thread_local int JobSystem::m_workerIndex = -1;
+thread_local const JobSystem *JobSystem::m_workerOwner = nullptr;
+
+JobSystem::JobSystem(unsigned workersCount)
+    : m_pendingJobs(0),
+      m_unfinishedJobs(0),
+      m_running(true)
+{
+    if (workersCount == 0) {
+        workersCount = max(thread::hardware_concurrency(), 2u) - 1;
+    }
+
+    // must be set before the workers are started
+    m_workersCount = workersCount;
+
+    for (unsigned i = 0; i < workersCount + 1; i++)
+        m_queues.emplace_back(make_unique<Queue>());
+
+    m_workers.reserve(workersCount);
+
+    for (unsigned i = 0; i < workersCount; i++) {
+        m_workers.emplace_back([this, i]() {
+            workerLoop(i);
+        });
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        lock_guard<mutex> lock(m_sleepMutex);
+        m_running = false;
+    }
+
+    m_wakeUp.notify_all();
+
+    for (auto &worker : m_workers) {
+        worker.join();
+    }
+}
+
+void JobSystem::submit(Job job) {
+    // workers push to their own queue, other threads - to the shared one
+    auto index = m_workerOwner == this ? m_workerIndex : static_cast<int>(m_workersCount);
+    auto &queue = *m_queues[index];
+
+    ++m_unfinishedJobs;
+
+    // counted before the push, so a thief can't decrement it first
+    {
+        lock_guard<mutex> lock(m_sleepMutex);
+        ++m_pendingJobs;
+    }
+
+    {
+        lock_guard<mutex> lock(queue.mutex);
+        queue.jobs.emplace_back(std::move(job));
+    }
+
+    m_wakeUp.notify_one();
+}
+
+bool JobSystem::tryRunJob() {
+    Job job;
+
+    if (takeJob(m_workerOwner == this ? m_workerIndex : -1, job)) {
+        runJob(job);
+        return true;
+    }
+
+    return false;
+}
+
+void JobSystem::drain() {
+    while (m_unfinishedJobs > 0) {
+        if (!tryRunJob()) {
+            this_thread::yield();
+        }
+    }
+}
+
+unsigned JobSystem::getWorkersCount() const {
+    return m_workersCount;
+}
+
+void JobSystem::workerLoop(unsigned index) {
+    m_workerIndex = static_cast<int>(index);
+    m_workerOwner = this;
+
+    while (true) {
+        Job job;
+
+        if (takeJob(m_workerIndex, job)) {
+            runJob(job);
+            continue;
+        }
+
+        unique_lock<mutex> lock(m_sleepMutex);
+
+        // the queues are empty: nothing is left to drain
+        if (!m_running) {
+            return;
+        }
+
+        m_wakeUp.wait(lock, [this]() {
+            return m_pendingJobs > 0 || !m_running;
+        });
+    }
+}
+
+bool JobSystem::takeJob(int index, Job &job) {
+    auto sharedIndex = static_cast<size_t>(m_workersCount);
+
+    // own queue first
+    bool found = index >= 0 && pop(*m_queues[index], job, true);
+
+    // then shared queue
+    if (!found)
+        found = pop(*m_queues[sharedIndex], job, false);
+
+    // then steal from the other workers
+    auto first = index >= 0 ? static_cast<size_t>(index) + 1 : 0;
+
+    for (size_t i = 0; !found && i < sharedIndex; i++) {
+        auto victim = (first + i) % sharedIndex;
+
+        if (static_cast<int>(victim) != index) {
+            found = pop(*m_queues[victim], job, false);
+        }
+    }
+
+    if (found)
+        --m_pendingJobs;
+
+    return found;
+}
+
+void JobSystem::runJob(Job &job) {
+    job();
+    --m_unfinishedJobs;
+}
+
+bool JobSystem::pop(Queue &queue, Job &job, bool back) {
+    lock_guard<mutex> lock(queue.mutex);
+
+    if (queue.jobs.empty())
+        return false;
+
+    if (back) {
+        job = std::move(queue.jobs.back());
+        queue.jobs.pop_back();
+    } else {
+        job = std::move(queue.jobs.front());
+        queue.jobs.pop_front();
+    }
+
+    return true;
+}
+
+JobGraph::Node JobGraph::add(JobSystem::Job job, initializer_list<Node> dependencies) {
+    auto node = static_cast<Node>(m_nodes.size());
+
+    auto data = make_unique<NodeData>();
+    data->job = std::move(job);
+    data->dependenciesCount = static_cast<unsigned>(dependencies.size());
+
+    for (Node dependency : dependencies)
+        m_nodes[dependency]->successors.push_back(node);
+
+    m_nodes.emplace_back(std::move(data));
+
+    return node;
+}
+
+void JobGraph::run(JobSystem &jobSystem) {
+    if (m_nodes.empty())
+        return;
+
+    m_remaining = static_cast<unsigned>(m_nodes.size());
+
+    for (auto &node : m_nodes)
+        node->pendingDependencies = node->dependenciesCount;
+
+    for (Node node = 0; node < m_nodes.size(); node++) {
+        if (m_nodes[node]->dependenciesCount == 0) {
+            schedule(jobSystem, node);
+        }
+    }
+
+    while (m_remaining > 0) {
+        if (!jobSystem.tryRunJob()) {
+            this_thread::yield();
+        }
+    }
+}
+
+void JobGraph::clear() {
+    m_nodes.clear();
+}
+
+bool JobGraph::empty() const {
+    return m_nodes.empty();
+}
+
+void JobGraph::schedule(JobSystem &jobSystem, Node node) {
+    jobSystem.submit([this, &jobSystem, node]() {
+        auto &data = *m_nodes[node];
+        data.job();
+
+        for (Node successor : data.successors) {
+            if (--m_nodes[successor]->pendingDependencies == 0) {
+                schedule(jobSystem, successor);
+            }
+        }
+
+        --m_remaining;
+    });
+}
@@ -0,0 +1,114 @@
+#ifndef ALGINE_EXAMPLES_JOBSYSTEM_H
+#define ALGINE_EXAMPLES_JOBSYSTEM_H
+
+#include <functional>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+/**
+ * Work-stealing thread pool. Each worker has its own deque: the owner
+ * takes jobs from the back (LIFO, cache friendly), idle workers steal from
+ * the front of the other deques. Jobs submitted from non-worker threads
+ * go to the shared queue. Jobs which are still queued when the system
+ * is destroyed are executed before the workers exit.
+ */
+class JobSystem {
+public:
+    using Job = std::function<void()>;
+
+public:
+    /**
+     * @param workersCount 0 - hardware concurrency - 1
+     */
+    explicit JobSystem(unsigned workersCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    void submit(Job job);
+
+    /**
+     * Executes one pending job on the calling thread, if any.
+     * Used by waiting threads to help the workers instead of blocking
+     * @return true if job has been executed
+     */
+    bool tryRunJob();
+
+    /**
+     * Executes jobs on the calling thread until all submitted jobs, including
+     * the ones submitted by the jobs meanwhile, are completed. Must be called
+     * by the owners of the jobs which capture them, before they are destroyed
+     */
+    void drain();
+
+    unsigned getWorkersCount() const;
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    void workerLoop(unsigned index);
+    bool takeJob(int index, Job &job);
+    void runJob(Job &job);
+    bool pop(Queue &queue, Job &job, bool back);
+
+private:
+    std::vector<std::unique_ptr<Queue>> m_queues; // workers queues + shared queue
+    std::vector<std::thread> m_workers;
+    unsigned m_workersCount;
+
+    std::atomic<unsigned> m_pendingJobs; // queued
+    std::atomic<unsigned> m_unfinishedJobs; // queued or running
+    std::atomic_bool m_running;
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wakeUp;
+
+    static thread_local int m_workerIndex;
+    static thread_local const JobSystem *m_workerOwner;
+};
+
+/**
+ * Dependency graph of jobs. Job is scheduled as soon as
+ * all its dependencies are completed. Graph can be run many times.
+ */
+class JobGraph {
+public:
+    using Node = unsigned;
+
+public:
+    Node add(JobSystem::Job job, std::initializer_list<Node> dependencies = {});
+
+    /**
+     * Runs the graph and waits for its completion.
+     * The calling thread executes jobs while waiting
+     */
+    void run(JobSystem &jobSystem);
+
+    void clear();
+
+    bool empty() const;
+
+private:
+    void schedule(JobSystem &jobSystem, Node node);
+
+private:
+    struct NodeData {
+        JobSystem::Job job;
+        std::vector<Node> successors;
+        unsigned dependenciesCount = 0;
+        std::atomic<unsigned> pendingDependencies {0};
+    };
+
+    std::vector<std::unique_ptr<NodeData>> m_nodes;
+    std::atomic<unsigned> m_remaining {0};
+};
+
+#endif //ALGINE_EXAMPLES_JOBSYSTEM_H
@@ -0,0 +1,200 @@
+#include "KTXFile.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <cstring>
+
+using namespace std;
+
+namespace {
+constexpr uint8_t Identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+constexpr uint32_t Endianness = 0x04030201;
+
+struct Header {
+    uint8_t identifier[12];
+    uint32_t endianness;
+    uint32_t glType;
+    uint32_t glTypeSize;
+    uint32_t glFormat;
+    uint32_t glInternalFormat;
+    uint32_t glBaseInternalFormat;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t numberOfArrayElements;
+    uint32_t numberOfFaces;
+    uint32_t numberOfMipmapLevels;
+    uint32_t bytesOfKeyValueData;
+};
+
+/**
+ * @return bytes per 4x4 block of the block-compressed formats, 0 if the format is unknown
+ */
+uint getBlockSize(uint glInternalFormat) {
+    switch (glInternalFormat) {
+        case 0x83F0: // BC1 RGB
+        case 0x83F1: // BC1 RGBA
+        case 0x8C4C: // BC1 sRGB
+        case 0x8C4D: // BC1 sRGB alpha
+        case 0x8DBB: // BC4
+        case 0x8DBC: // BC4 signed
+        case 0x9274: // ETC2 RGB8
+        case 0x9275: // ETC2 sRGB8
+            return 8;
+        case 0x83F2: // BC2
+        case 0x83F3: // BC3
+        case 0x8C4E: // BC2 sRGB
+        case 0x8C4F: // BC3 sRGB
+        case 0x8DBD: // BC5
+        case 0x8DBE: // BC5 signed
+        case 0x9278: // ETC2 RGBA8
+        case 0x9279: // ETC2 sRGB8 alpha
+        case 0x93B0: // ASTC 4x4
+        case 0x93D0: // ASTC 4x4 sRGB
+            return 16;
+        default:
+            return 0;
+    }
+}
+}
+
+bool readKTX(const string &path, KTXImage &image) {
+    ifstream file(path, ios::binary);
+
+    if (!file.is_open()) {
+        cerr << "KTX: can't open " << path << "\n";
+        return false;
+    }
+
+    Header header;
+
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        memcmp(header.identifier, Identifier, sizeof(Identifier)) != 0)
+    {
+        cerr << "KTX: " << path << " is not a KTX 1.1 file\n";
+        return false;
+    }
+
+    if (header.endianness != Endianness) {
+        cerr << "KTX: " << path << ": big endian files are not supported\n";
+        return false;
+    }
+
+    if (header.pixelDepth > 1 || header.numberOfArrayElements > 0 || header.numberOfFaces != 1) {
+        cerr << "KTX: " << path << ": only 2D textures are supported\n";
+        return false;
+    }
+
+    image.glType = header.glType;
+    image.glFormat = header.glFormat;
+    image.glInternalFormat = header.glInternalFormat;
+    image.glBaseInternalFormat = header.glBaseInternalFormat;
+    image.width = header.pixelWidth;
+    image.height = header.pixelHeight;
+
+    // sizes are read from the file, so they are validated before any allocation
+    if (image.width == 0 || image.height == 0) {
+        cerr << "KTX: " << path << ": invalid size " << image.width << "x" << image.height << "\n";
+        return false;
+    }
+
+    uint maxLevelsCount = 1;
+
+    while ((max(image.width, image.height) >> maxLevelsCount) != 0)
+        ++maxLevelsCount;
+
+    // 0 means that mipmaps must be generated
+    uint levelsCount = header.numberOfMipmapLevels == 0 ? 1 : header.numberOfMipmapLevels;
+
+    if (levelsCount > maxLevelsCount) {
+        cerr << "KTX: " << path << ": " << levelsCount << " levels, at most " << maxLevelsCount << " expected\n";
+        return false;
+    }
+
+    file.seekg(0, ios::end);
+    auto fileSize = static_cast<uint64_t>(file.tellg());
+
+    file.seekg(sizeof(header) + static_cast<uint64_t>(header.bytesOfKeyValueData), ios::beg);
+
+    auto blockSize = getBlockSize(image.glInternalFormat);
+
+    image.levels.resize(levelsCount);
+
+    for (uint index = 0; index < levelsCount; index++) {
+        auto &level = image.levels[index];
+        uint32_t imageSize;
+
+        if (!file.read(reinterpret_cast<char*>(&imageSize), sizeof(imageSize))) {
+            cerr << "KTX: " << path << " is truncated\n";
+            return false;
+        }
+
+        auto remaining = fileSize - static_cast<uint64_t>(file.tellg());
+
+        if (imageSize > remaining) {
+            cerr << "KTX: " << path << ": level " << index << " is truncated\n";
+            return false;
+        }
+
+        if (image.isCompressed() && blockSize != 0) {
+            uint64_t blocksX = (max(image.width >> index, 1u) + 3) / 4;
+            uint64_t blocksY = (max(image.height >> index, 1u) + 3) / 4;
+
+            if (imageSize != blocksX * blocksY * blockSize) {
+                cerr << "KTX: " << path << ": level " << index << " has invalid size " << imageSize << "\n";
+                return false;
+            }
+        }
+
+        level.resize(imageSize);
+        file.read(reinterpret_cast<char*>(level.data()), imageSize);
+
+        // mip padding
+        file.seekg((4 - imageSize % 4) % 4, ios::cur);
+    }
+
+    if (!file) {
+        cerr << "KTX: " << path << " is truncated\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool writeKTX(const string &path, const KTXImage &image) {
+    ofstream file(path, ios::binary);
+
+    if (!file.is_open()) {
+        cerr << "KTX: can't write " << path << "\n";
+        return false;
+    }
+
+    Header header {};
+    memcpy(header.identifier, Identifier, sizeof(Identifier));
+    header.endianness = Endianness;
+    header.glType = image.glType;
+    header.glTypeSize = 1; // compressed or ubyte data
+    header.glFormat = image.glFormat;
+    header.glInternalFormat = image.glInternalFormat;
+    header.glBaseInternalFormat = image.glBaseInternalFormat;
+    header.pixelWidth = image.width;
+    header.pixelHeight = image.height;
+    header.numberOfFaces = 1;
+    header.numberOfMipmapLevels = static_cast<uint32_t>(image.levels.size());
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (auto &level : image.levels) {
+        auto imageSize = static_cast<uint32_t>(level.size());
+
+        file.write(reinterpret_cast<const char*>(&imageSize), sizeof(imageSize));
+        file.write(reinterpret_cast<const char*>(level.data()), imageSize);
+
+        for (uint i = 0; i < (4 - imageSize % 4) % 4; i++) {
+            file.put(0);
+        }
+    }
+
+    return file.good();
+}
@@ -0,0 +1,33 @@
+#ifndef ALGINE_EXAMPLES_KTXFILE_H
+#define ALGINE_EXAMPLES_KTXFILE_H
+
+#include <algine/types.h>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+using namespace algine;
+
+/**
+ * 2D texture with its mip chain, stored in KTX 1.1 container.
+ * For the compressed formats (BC, ETC, ASTC) <code>glType</code> and <code>glFormat</code> are 0
+ */
+struct KTXImage {
+    uint glType = 0;
+    uint glFormat = 0;
+    uint glInternalFormat = 0;
+    uint glBaseInternalFormat = 0;
+    uint width = 0;
+    uint height = 0;
+    std::vector<std::vector<uint8_t>> levels;
+
+    inline bool isCompressed() const {
+        return glType == 0;
+    }
+};
+
+bool readKTX(const std::string &path, KTXImage &image);
+bool writeKTX(const std::string &path, const KTXImage &image);
+
+#endif //ALGINE_EXAMPLES_KTXFILE_H
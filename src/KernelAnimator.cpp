@@ -0,0 +1,171 @@
+#include "KernelAnimator.h"
+
+#include <algine/std/model/Shape.h>
+
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <unordered_map>
+#include <functional>
+#include <cstring>
+#include <cmath>
+
+using namespace AnimationKernels;
+using namespace std;
+
+namespace {
+Mat4 toMat4(const glm::mat4 &matrix) {
+    Mat4 result;
+    memcpy(result.m, glm::value_ptr(matrix), sizeof(result.m));
+    return result;
+}
+
+Key toKey(float time, const glm::vec3 &value) {
+    return {time, {value.x, value.y, value.z, 0.0f}};
+}
+
+Key toKey(float time, const glm::quat &value) {
+    return {time, {value.x, value.y, value.z, value.w}};
+}
+
+template<typename T>
+vector<Key> toKeys(const vector<T> &keys) {
+    vector<Key> result;
+    result.reserve(keys.size());
+
+    for (auto &key : keys)
+        result.emplace_back(toKey(static_cast<float>(key.time), key.value));
+
+    return result;
+}
+
+/**
+ * Single key of the default transformation, which must be T * R * S
+ */
+Channel toChannel(const glm::mat4 &transform) {
+    glm::vec3 scale(glm::length(glm::vec3(transform[0])),
+                    glm::length(glm::vec3(transform[1])),
+                    glm::length(glm::vec3(transform[2])));
+
+    glm::mat3 rotation(glm::vec3(transform[0]) / scale.x,
+                       glm::vec3(transform[1]) / scale.y,
+                       glm::vec3(transform[2]) / scale.z);
+
+    Channel channel;
+    channel.positions = {toKey(0.0f, glm::vec3(transform[3]))};
+    channel.rotations = {toKey(0.0f, glm::quat_cast(rotation))};
+    channel.scales = {toKey(0.0f, scale)};
+
+    return channel;
+}
+}
+
+void KernelAnimator::init(const ShapePtr &shape) {
+    m_clips.clear();
+    m_parents.clear();
+    m_bones.clear();
+    m_offsets.clear();
+
+    auto &shapeBones = shape->getBones();
+
+    unordered_map<string, int> boneIndices;
+
+    for (usize i = 0; i < shapeBones.size(); i++)
+        boneIndices[shapeBones[i].name] = static_cast<int>(i);
+
+    m_bonesCount = static_cast<uint>(shapeBones.size());
+
+    // preorder, so the parents precede their children
+    vector<const Node*> nodes;
+
+    function<void(const Node&, int)> flatten = [&](const Node &node, int parent) {
+        auto index = static_cast<int>(nodes.size());
+        auto bone = boneIndices.find(node.name);
+        bool isBone = bone != boneIndices.end();
+
+        nodes.emplace_back(&node);
+        m_parents.emplace_back(parent);
+        m_bones.emplace_back(isBone ? bone->second : -1);
+        m_offsets.emplace_back(isBone ? toMat4(shapeBones[bone->second].offsetMatrix) : Mat4::identity());
+
+        for (auto &child : node.childs) {
+            flatten(child, index);
+        }
+    };
+
+    flatten(shape->getRootNode(), -1);
+
+    m_globalInverse = toMat4(shape->getGlobalInverseTransform());
+
+    for (uint i = 0; i < shape->getAnimationsAmount(); i++) {
+        auto &animation = shape->getAnimation(i);
+
+        unordered_map<string, const AnimNode*> animNodes;
+
+        for (auto &animNode : animation.getChannels())
+            animNodes[animNode.name] = &animNode;
+
+        vector<Channel> channels;
+        channels.reserve(nodes.size());
+
+        for (auto node : nodes) {
+            auto animNode = animNodes.find(node->name);
+
+            if (animNode == animNodes.end()) {
+                channels.emplace_back(toChannel(node->defaultTransform));
+                continue;
+            }
+
+            auto &channel = channels.emplace_back();
+            channel.positions = toKeys(animNode->second->positionKeys);
+            channel.rotations = toKeys(animNode->second->rotationKeys);
+            channel.scales = toKeys(animNode->second->scalingKeys);
+        }
+
+        auto &clip = m_clips.emplace_back();
+        clip.keys.build(channels);
+
+        // the same defaults as Animator
+        auto ticksPerSecond = static_cast<float>(animation.getTicksPerSecond());
+        clip.ticksPerSecond = ticksPerSecond != 0.0f ? ticksPerSecond : 25.0f;
+        clip.duration = static_cast<float>(animation.getDuration());
+    }
+
+    m_local.resize(nodes.size());
+    m_global.resize(nodes.size());
+    m_palette.resize(nodes.size());
+}
+
+void KernelAnimator::sample(uint clip, float time, PoseSoA &pose) const {
+    auto &source = m_clips[clip];
+    auto ticks = time * source.ticksPerSecond;
+
+    sampleClip(source.keys, source.duration > 0.0f ? fmod(ticks, source.duration) : 0.0f, pose);
+}
+
+void KernelAnimator::computeBones(const PoseSoA &pose, Bones &bones) {
+    composeMatrices(pose, m_local.data());
+    concatenateHierarchy(m_parents.data(), m_local.data(), m_offsets.data(), m_globalInverse,
+                         static_cast<uint>(m_local.size()), m_global.data(), m_palette.data());
+
+    bones.resize(m_bonesCount);
+
+    for (usize i = 0; i < m_palette.size(); i++) {
+        if (m_bones[i] != -1) {
+            memcpy(glm::value_ptr(bones[m_bones[i]]), m_palette[i].m, sizeof(Mat4::m));
+        }
+    }
+}
+
+void KernelAnimator::animate(uint clip, float time, Bones &bones) {
+    sample(clip, time, m_pose);
+    computeBones(m_pose, bones);
+}
+
+uint KernelAnimator::getClipsCount() const {
+    return static_cast<uint>(m_clips.size());
+}
+
+uint KernelAnimator::getBonesCount() const {
+    return m_bonesCount;
+}
@@ -0,0 +1,66 @@
+#ifndef ALGINE_EXAMPLES_KERNELANIMATOR_H
+#define ALGINE_EXAMPLES_KERNELANIMATOR_H
+
+#include <algine/std/model/ShapePtr.h>
+#include <algine/types.h>
+
+#include <glm/mat4x4.hpp>
+
+#include <vector>
+
+#include "AnimationKernels.h"
+
+using namespace algine;
+
+/**
+ * Animates the bones of a shape by the SoA kernels (AnimationKernels.h) instead of
+ * <code>Animator</code>. Clips are converted once by <code>init</code>: the node hierarchy
+ * is flattened (parents first), nodes without channels get a single key of their
+ * default transformation. The bones are the same as the bones of the animation
+ * after <code>Animator::animate</code>, in the same order.
+ * Not thread safe: one instance per animating thread
+ */
+class KernelAnimator {
+public:
+    using Bones = std::vector<glm::mat4>;
+
+public:
+    void init(const ShapePtr &shape);
+
+    /**
+     * @param time in seconds, looped as by <code>Animator</code>
+     */
+    void sample(uint clip, float time, AnimationKernels::PoseSoA &pose) const;
+
+    void computeBones(const AnimationKernels::PoseSoA &pose, Bones &bones);
+
+    /**
+     * <code>sample</code> followed by <code>computeBones</code>
+     */
+    void animate(uint clip, float time, Bones &bones);
+
+    uint getClipsCount() const;
+    uint getBonesCount() const;
+
+private:
+    struct Clip {
+        AnimationKernels::ClipSoA keys;
+        float ticksPerSecond;
+        float duration;
+    };
+
+private:
+    std::vector<Clip> m_clips;
+    std::vector<int> m_parents;
+    std::vector<int> m_bones; // bone index of each node, -1 if the node is not a bone
+    std::vector<AnimationKernels::Mat4> m_offsets;
+    AnimationKernels::Mat4 m_globalInverse;
+    uint m_bonesCount = 0;
+
+    AnimationKernels::PoseSoA m_pose;
+    std::vector<AnimationKernels::Mat4> m_local;
+    std::vector<AnimationKernels::Mat4> m_global;
+    std::vector<AnimationKernels::Mat4> m_palette;
+};
+
+#endif //ALGINE_EXAMPLES_KERNELANIMATOR_H
@@ -1,23 +1,42 @@
 #include "LampMoveThread.h"
 
-#include "ExampleChessContent.h"
+#include <glm/gtc/matrix_transform.hpp>
 
-#include <algine/std/model/Model.h>
+// degrees per second
+constexpr static float angularSpeed = 10.0f;
 
-#include <glm/gtc/matrix_transform.hpp>
+LampMoveThread::LampMoveThread()
+    : startPos(0.0f),
+      pos(0.0f),
+      time(0.0) {}
+
+void LampMoveThread::setPos(const glm::vec3 &p) {
+    startPos = p;
+    pos = p;
+    state.reset({p, p, time});
+}
 
-#include <thread>
+void LampMoveThread::execute(float dt) {
+    glm::mat3 rotate = glm::rotate(glm::mat4(1.0f), glm::radians(angularSpeed * dt), glm::vec3(0, 1, 0));
 
-using namespace std;
+    auto &next = state.back();
+    next.prevPos = pos;
 
-LampMoveThread::LampMoveThread()
-    : content(nullptr),
-      rotate(glm::rotate(glm::mat4(1.0f), glm::radians(0.01f), glm::vec3(0, 1, 0))) {}
+    pos = pos * rotate;
+    time += dt;
 
-void LampMoveThread::execute() {
-    this_thread::sleep_for(chrono::milliseconds(1));
+    next.pos = pos;
+    next.time = time;
+
+    state.publish();
+}
+
+void LampMoveThread::resetState() {
+    pos = startPos;
+    time = 0.0;
+    state.reset({pos, pos, time});
+}
 
-    content->pointLamps[0].setPos(content->pointLamps[0].m_pos * rotate);
-    content->pointLamps[0].translate();
-    content->pointLamps[0].mptr->transform();
+const LampMoveThread::State& LampMoveThread::getState() {
+    return state.read();
 }
@@ -2,22 +2,46 @@
 #define ALGINE_EXAMPLES_LAMPMOVETHREAD_H
 
 #include "LoopThread.h"
+#include "TripleBuffer.h"
 
-#include <glm/mat4x4.hpp>
-
-class ExampleChessContent;
+#include <glm/vec3.hpp>
 
+/**
+ * Rotates the lamp around Y axis. The lamp itself is not touched:
+ * simulation results are published via triple buffer and applied
+ * by the render thread
+ */
 class LampMoveThread: public LoopThread {
+public:
+    struct State {
+        glm::vec3 prevPos {0.0f};
+        glm::vec3 pos {0.0f};
+        double time = 0.0; // simulation time of pos, prevPos is one tick earlier
+    };
+
 public:
     LampMoveThread();
 
-    void execute() override;
+    /**
+     * Must be called before the loop is started
+     */
+    void setPos(const glm::vec3 &pos);
 
-public:
-    ExampleChessContent *content;
+    void execute(float dt) override;
+
+    /**
+     * Must be called only by the render thread
+     */
+    const State& getState();
+
+protected:
+    void resetState() override;
 
 private:
-    glm::mat3 rotate;
+    TripleBuffer<State> state;
+    glm::vec3 startPos;
+    glm::vec3 pos;
+    double time;
 };
 
 
@@ -1,12 +1,53 @@
 #include "LoopThread.h"
 
+using namespace std;
+
 LoopThread::LoopThread()
-    : m_isLoopRunning(true) {}
+    : m_isLoopRunning(false),
+      m_tickRate(60),
+      m_ticks(0),
+      m_start(Clock::now()) {}
+
+void LoopThread::setTickRate(uint32_t ticksPerSecond) {
+    m_tickRate = ticksPerSecond;
+}
+
+uint32_t LoopThread::getTickRate() const {
+    return m_tickRate;
+}
+
+float LoopThread::getTickDuration() const {
+    return 1.0f / static_cast<float>(m_tickRate);
+}
 
 void LoopThread::startLoop() {
-    m_thread = std::thread([&]() {
+    if (m_thread.joinable())
+        return;
+
+    chrono::duration<double> tickDuration(getTickDuration());
+
+    // continue from the current simulation time
+    m_start = Clock::now() - chrono::duration_cast<Clock::duration>(tickDuration * m_ticks.load());
+    m_isLoopRunning = true;
+
+    m_thread = std::thread([this, tickDuration]() {
         while (isLoopRunning()) {
-            execute();
+            auto next = m_start + chrono::duration_cast<Clock::duration>(tickDuration * m_ticks.load());
+            auto now = Clock::now();
+
+            if (now < next) {
+                this_thread::sleep_until(next);
+                continue;
+            }
+
+            // too far behind: skip the missed ticks instead of
+            // running the simulation faster than real time
+            auto behind = static_cast<uint64_t>((now - next) / tickDuration);
+
+            if (behind > maxCatchUpTicks)
+                m_ticks += behind - maxCatchUpTicks;
+
+            tick();
         }
     });
 }
@@ -14,9 +55,43 @@ void LoopThread::startLoop() {
 void LoopThread::stopLoop() {
     m_isLoopRunning = false;
 
-    m_thread.join();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void LoopThread::advanceTo(double time) {
+    while (getTime() < time) {
+        tick();
+    }
+}
+
+void LoopThread::reset() {
+    resetState();
+    m_ticks = 0;
+}
+
+void LoopThread::seek(uint64_t ticks) {
+    reset();
+
+    for (uint64_t i = 0; i < ticks; i++) {
+        tick();
+    }
+}
+
+double LoopThread::getClock() const {
+    return chrono::duration<double>(Clock::now() - m_start).count();
+}
+
+double LoopThread::getTime() const {
+    return static_cast<double>(m_ticks.load()) * getTickDuration();
 }
 
 const std::atomic_bool& LoopThread::isLoopRunning() const {
     return m_isLoopRunning;
 }
+
+void LoopThread::tick() {
+    execute(getTickDuration());
+    ++m_ticks;
+}
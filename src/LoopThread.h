@@ -3,21 +3,84 @@
 
 #include <thread>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 
+/**
+ * Fixed-timestep scheduler: <code>execute</code> is called
+ * <code>tickRate</code> times per second with the constant time step.
+ * If the thread falls behind, missed ticks are caught up (up to
+ * <code>maxCatchUpTicks</code>), otherwise the thread sleeps until the next tick.
+ */
 class LoopThread {
 public:
     LoopThread();
+    virtual ~LoopThread() = default;
 
-    virtual void execute() = 0;
+    /**
+     * @param dt time step, in seconds
+     */
+    virtual void execute(float dt) = 0;
+
+    void setTickRate(uint32_t ticksPerSecond);
+    uint32_t getTickRate() const;
+    float getTickDuration() const;
 
     void startLoop();
     void stopLoop();
 
+    /**
+     * Executes ticks on the calling thread until simulation time reaches <code>time</code>.
+     * Can be used only when the loop is not running, e.g. for deterministic playback
+     * @param time in seconds
+     */
+    void advanceTo(double time);
+
+    /**
+     * Returns the simulation to its initial state, see <code>resetState</code>.
+     * Can be used only when the loop is not running
+     */
+    void reset();
+
+    /**
+     * Resets the simulation and executes <code>ticks</code> ticks on the calling thread,
+     * so the result doesn't depend on when and how long the loop was running before.
+     * Can be used only when the loop is not running
+     */
+    void seek(uint64_t ticks);
+
+    /**
+     * @return seconds since the loop was started
+     */
+    double getClock() const;
+
+    /**
+     * Each tick advances the simulation by <code>getTickDuration()</code> seconds
+     * @return simulation time reached by the executed ticks, in seconds
+     */
+    double getTime() const;
+
     const std::atomic_bool& isLoopRunning() const;
 
+protected:
+    /**
+     * Called by <code>reset</code>, restores the state the simulation had before the first tick
+     */
+    virtual void resetState() {}
+
+private:
+    void tick();
+
 private:
+    using Clock = std::chrono::steady_clock;
+
+    constexpr static uint32_t maxCatchUpTicks = 5;
+
     std::thread m_thread;
     std::atomic_bool m_isLoopRunning;
+    std::atomic<uint32_t> m_tickRate;
+    std::atomic<uint64_t> m_ticks;
+    Clock::time_point m_start;
 };
 
 #endif //ALGINE_EXAMPLES_LOOPTHREAD_H
@@ -2,20 +2,189 @@
 
 #include <algine/core/Engine.h>
 
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <cstring>
+#include <limits>
+#include <string>
+
 #include "ExampleChessContent.h"
+#include "Benchmark.h"
+
+constexpr char usage[] =
+    "Usage: examples [--benchmark] [--headless] [--frames N] [--warmup N] [--output file.json] [--trace trace.json]\n"
+    "                [--point-shadows gs|instanced|faces] [--pre-skinning] [--compact-gbuffer]\n"
+    "                [--ssr linear|hiz|hiz-half] [--blur pingpong|linear|compute|kawase]\n";
+
+/**
+ * @return false if <code>str</code> is not an unsigned number
+ */
+bool parseUInt(const char *str, uint &result) {
+    try {
+        size_t end;
+        auto value = std::stoul(str, &end);
+
+        if (str[end] != '\0' || str[0] == '-' || value > std::numeric_limits<uint>::max())
+            return false;
+
+        result = static_cast<uint>(value);
+
+        return true;
+    } catch (const std::invalid_argument&) {
+        return false;
+    } catch (const std::out_of_range&) {
+        return false;
+    }
+}
+
+/**
+ * Usage: examples [--benchmark] [--headless] [--frames N] [--warmup N] [--output file.json] [--trace trace.json]
+ *                 [--point-shadows gs|instanced|faces] [--pre-skinning] [--compact-gbuffer]
+ *                 [--ssr linear|hiz|hiz-half] [--blur pingpong|linear|compute|kawase]
+ * --benchmark  renders fixed amount of frames along the scripted camera path,
+ *              writes timings to json and exits
+ * --headless   creates offscreen (OSMesa) context instead of the visible window,
+ *              e.g. for software rendering by Mesa llvmpipe
+ * --point-shadows  how point light cubemaps are filled: by the geometry shader (default),
+ *                  by instanced layered rendering or by separate passes per face
+ * --pre-skinning   skinned models are skinned once per frame by transform feedback,
+ *                  instead of skinning them in every pass
+ * --compact-gbuffer  G-buffer without the position map and with packed normals,
+ *                    positions are reconstructed from depth
+ * --ssr  how reflections are traced: by the linear ray march (default), by the hierarchical
+ *        traversal of the Hi-Z pyramid, or by the same at the half resolution
+ * --blur  backend of the bloom, CoC and DOF blurs: the engine's ping-pong blur (default),
+ *         linear sampling with merged taps, compute shader with shared memory tiles
+ *         or dual Kawase downsample chain for the large radii, see GaussianBlur
+ */
+int main(int argc, char *argv[]) {
+    bool benchmark = false;
+    bool headless = false;
+    auto pointShadowMode = ExampleChessContent::PointShadowMode::GeometryShader;
+    bool preSkinning = false;
+    bool compactGBuffer = false;
+    auto ssrMode = ExampleChessContent::SSRMode::Linear;
+    auto blurMode = GaussianBlur::Mode::PingPong;
+    Benchmark::Options benchmarkOptions;
+
+    for (int i = 1; i < argc; i++) {
+        auto isArg = [&](const char *name) {
+            return strcmp(argv[i], name) == 0;
+        };
+
+        auto hasValue = i + 1 < argc;
+
+        if (isArg("--benchmark")) {
+            benchmark = true;
+        } else if (isArg("--headless")) {
+            headless = true;
+        } else if (isArg("--frames") && hasValue) {
+            if (!parseUInt(argv[++i], benchmarkOptions.frames)) {
+                std::cerr << "Invalid number of frames " << argv[i] << "\n" << usage;
+                return 1;
+            }
+        } else if (isArg("--warmup") && hasValue) {
+            if (!parseUInt(argv[++i], benchmarkOptions.warmupFrames)) {
+                std::cerr << "Invalid number of warmup frames " << argv[i] << "\n" << usage;
+                return 1;
+            }
+        } else if (isArg("--output") && hasValue) {
+            benchmarkOptions.output = argv[++i];
+        } else if (isArg("--trace") && hasValue) {
+            benchmarkOptions.trace = argv[++i];
+        } else if (isArg("--point-shadows") && hasValue) {
+            using Mode = ExampleChessContent::PointShadowMode;
+
+            std::string mode = argv[++i];
+
+            if (mode == "gs") {
+                pointShadowMode = Mode::GeometryShader;
+            } else if (mode == "instanced") {
+                pointShadowMode = Mode::Instanced;
+            } else if (mode == "faces") {
+                pointShadowMode = Mode::PerFace;
+            } else {
+                std::cerr << "Unknown point shadows mode " << mode << "\n";
+                return 1;
+            }
+        } else if (isArg("--pre-skinning")) {
+            preSkinning = true;
+        } else if (isArg("--compact-gbuffer")) {
+            compactGBuffer = true;
+        } else if (isArg("--ssr") && hasValue) {
+            using Mode = ExampleChessContent::SSRMode;
+
+            std::string mode = argv[++i];
+
+            if (mode == "linear") {
+                ssrMode = Mode::Linear;
+            } else if (mode == "hiz") {
+                ssrMode = Mode::HiZ;
+            } else if (mode == "hiz-half") {
+                ssrMode = Mode::HiZHalf;
+            } else {
+                std::cerr << "Unknown SSR mode " << mode << "\n";
+                return 1;
+            }
+        } else if (isArg("--blur") && hasValue) {
+            using Mode = GaussianBlur::Mode;
+
+            std::string mode = argv[++i];
+
+            if (mode == "pingpong") {
+                blurMode = Mode::PingPong;
+            } else if (mode == "linear") {
+                blurMode = Mode::Linear;
+            } else if (mode == "compute") {
+                blurMode = Mode::Compute;
+            } else if (mode == "kawase") {
+                blurMode = Mode::DualKawase;
+            } else {
+                std::cerr << "Unknown blur mode " << mode << "\n";
+                return 1;
+            }
+        } else {
+            std::cerr << "Unknown argument " << argv[i] << "\n" << usage;
+            return 1;
+        }
+    }
 
-int main() {
     Engine::init();
 
+    if (headless) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+    }
+
     Window window("Algine", 1366, 768);
-    window.setFullscreenDimensions(1366, 768);
-    window.setIcon(Icon("src/resources/icon64x64.png"));
-    window.setMouseTracking(true);
-    window.setKeyboardTracking(true);
-    window.setWindowStateTracking(true);
-    window.setCursorMode(Window::CursorMode::Disabled);
-    window.setContent(new ExampleChessContent);
-    window.renderLoop();
+
+    auto content = new ExampleChessContent;
+    content->setPointShadowMode(pointShadowMode);
+    content->setPreSkinningEnabled(preSkinning);
+    content->setCompactGBufferEnabled(compactGBuffer);
+    content->setSSRMode(ssrMode);
+    content->setBlurMode(blurMode);
+
+    if (!headless) {
+        window.setFullscreenDimensions(1366, 768);
+        window.setIcon(Icon("src/resources/icon64x64.png"));
+        window.setMouseTracking(true);
+        window.setKeyboardTracking(true);
+        window.setWindowStateTracking(true);
+        window.setCursorMode(Window::CursorMode::Disabled);
+    }
+
+    window.setContent(content);
+
+    if (benchmark) {
+        Benchmark bench(content, benchmarkOptions);
+        bench.run();
+        bench.write();
+    } else {
+        window.renderLoop();
+    }
 
     Engine::destroy();
 
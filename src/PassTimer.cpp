@@ -0,0 +1,97 @@
+#include "PassTimer.h"
+
+#include <algine/gl.h>
+
+using namespace std;
+
+PassTimer::PassTimer()
+    : m_usedQueries(0)
+{
+    glGenQueries(2, m_frameQueries);
+}
+
+PassTimer::~PassTimer() {
+    glDeleteQueries(2, m_frameQueries);
+
+    if (!m_queries.empty()) {
+        glDeleteQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+    }
+}
+
+void PassTimer::beginFrame() {
+    m_timings.fill({});
+    m_ranges.clear();
+    m_usedQueries = 0;
+
+    m_frameStart = Clock::now();
+    glQueryCounter(m_frameQueries[0], GL_TIMESTAMP);
+}
+
+void PassTimer::endFrame() {
+    glQueryCounter(m_frameQueries[1], GL_TIMESTAMP);
+
+    m_frameTiming.cpu = chrono::duration<double, milli>(Clock::now() - m_frameStart).count();
+
+    // waits for the GPU, so it must be called only when
+    // accurate per-pass timings are more important than the frame rate
+    for (auto &range : m_ranges) {
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(range.query, GL_QUERY_RESULT, &elapsed);
+        m_timings[range.pass].gpu += static_cast<double>(elapsed) / 1e6;
+    }
+
+    GLuint64 frameBegin = 0, frameEnd = 0;
+    glGetQueryObjectui64v(m_frameQueries[0], GL_QUERY_RESULT, &frameBegin);
+    glGetQueryObjectui64v(m_frameQueries[1], GL_QUERY_RESULT, &frameEnd);
+
+    m_frameTiming.gpu = static_cast<double>(frameEnd - frameBegin) / 1e6;
+}
+
+void PassTimer::begin(Pass pass) {
+    uint query = getQuery();
+
+    m_ranges.push_back({pass, query});
+    m_cpuStart[pass] = Clock::now();
+
+    glBeginQuery(GL_TIME_ELAPSED, query);
+}
+
+void PassTimer::end(Pass pass) {
+    glEndQuery(GL_TIME_ELAPSED);
+
+    m_timings[pass].cpu += chrono::duration<double, milli>(Clock::now() - m_cpuStart[pass]).count();
+}
+
+const PassTimer::Timing& PassTimer::getTiming(Pass pass) const {
+    return m_timings[pass];
+}
+
+const PassTimer::Timing& PassTimer::getFrameTiming() const {
+    return m_frameTiming;
+}
+
+const char* PassTimer::getPassName(Pass pass) {
+    switch (pass) {
+        case ShadowCubemap: return "shadowCubemap";
+        case DirShadow: return "dirShadow";
+        case GBuffer: return "gBuffer";
+        case Skybox: return "skybox";
+        case HiZ: return "hiZ";
+        case SSR: return "ssr";
+        case Bloom: return "bloom";
+        case CoC: return "coc";
+        case DOF: return "dof";
+        case Blend: return "blend";
+        default: return "unknown";
+    }
+}
+
+uint PassTimer::getQuery() {
+    if (m_usedQueries == m_queries.size()) {
+        uint query;
+        glGenQueries(1, &query);
+        m_queries.push_back(query);
+    }
+
+    return m_queries[m_usedQueries++];
+}
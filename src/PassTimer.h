@@ -0,0 +1,77 @@
+#ifndef ALGINE_EXAMPLES_PASSTIMER_H
+#define ALGINE_EXAMPLES_PASSTIMER_H
+
+#include <algine/types.h>
+
+#include <array>
+#include <vector>
+#include <chrono>
+
+using namespace algine;
+
+/**
+ * Measures CPU and GPU time of the render passes.
+ * GPU time is measured by GL_TIME_ELAPSED queries, the whole frame
+ * is additionally measured by GL_TIMESTAMP queries.
+ * Pass can be executed several times per frame (e.g. shadow cubemap
+ * for each point lamp), in this case its timings are accumulated.
+ */
+class PassTimer {
+public:
+    enum Pass {
+        ShadowCubemap,
+        DirShadow,
+        GBuffer,
+        Skybox,
+        HiZ,
+        SSR,
+        Bloom,
+        CoC,
+        DOF,
+        Blend,
+        PassesCount
+    };
+
+    struct Timing {
+        double cpu = 0.0; // in ms
+        double gpu = 0.0; // in ms
+    };
+
+public:
+    PassTimer();
+    ~PassTimer();
+
+    void beginFrame();
+    void endFrame();
+
+    void begin(Pass pass);
+    void end(Pass pass);
+
+    const Timing& getTiming(Pass pass) const;
+    const Timing& getFrameTiming() const;
+
+    static const char* getPassName(Pass pass);
+
+private:
+    uint getQuery();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Range {
+        Pass pass;
+        uint query;
+    };
+
+    std::array<Timing, PassesCount> m_timings;
+    std::array<Clock::time_point, PassesCount> m_cpuStart;
+    Timing m_frameTiming;
+    Clock::time_point m_frameStart;
+
+    std::vector<uint> m_queries;
+    std::vector<Range> m_ranges;
+    usize m_usedQueries;
+    uint m_frameQueries[2];
+};
+
+#endif //ALGINE_EXAMPLES_PASSTIMER_H
@@ -0,0 +1,13 @@
+#ifndef POINTSHADOWSHADER_H
+#define POINTSHADOWSHADER_H
+
+#define constant(name, val) constexpr char name[] = val;
+
+namespace PointShadowShader::Vars {
+constant(Face, "face")
+constant(InPos, "a_Position") // shared by the dir shadow program
+}
+
+#undef constant
+
+#endif //POINTSHADOWSHADER_H
@@ -0,0 +1,277 @@
+#include "PreSkinning.h"
+#include "SkinningShader.h"
+
+#include <algine/core/shader/ShaderProgram.h>
+#include <algine/std/model/Shape.h>
+#include <algine/std/model/Model.h>
+#include <algine/gl.h>
+
+#include <algorithm>
+#include <iostream>
+#include <cstdint>
+
+using namespace std;
+
+namespace {
+// interleaved skinned vertex: position, normal, tangent, bitangent
+constexpr uint SkinnedStride = 4 * sizeof(float[3]);
+
+struct AttribState {
+    GLint location;
+    GLint enabled;
+    GLint buffer;
+    GLint size;
+    GLint type;
+    GLint normalized;
+    GLint integer;
+    GLint stride;
+    GLint divisor;
+    void *pointer;
+};
+
+uint getTypeSize(GLint type) {
+    switch (type) {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE: return 1;
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+        case GL_HALF_FLOAT: return 2;
+        case GL_DOUBLE: return 8;
+        default: return 4;
+    }
+}
+
+AttribState readAttrib(GLint location) {
+    AttribState state {};
+    state.location = location;
+
+    glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &state.enabled);
+    glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &state.buffer);
+    glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_SIZE, &state.size);
+    glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_TYPE, &state.type);
+    glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_NORMALIZED, &state.normalized);
+    glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_INTEGER, &state.integer);
+    glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_STRIDE, &state.stride);
+    glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_DIVISOR, &state.divisor);
+    glGetVertexAttribPointerv(location, GL_VERTEX_ATTRIB_ARRAY_POINTER, &state.pointer);
+
+    if (state.stride == 0)
+        state.stride = state.size * static_cast<GLint>(getTypeSize(state.type));
+
+    return state;
+}
+
+void writeAttrib(GLint location, const AttribState &state) {
+    glBindBuffer(GL_ARRAY_BUFFER, state.buffer);
+
+    if (state.integer) {
+        glVertexAttribIPointer(location, state.size, state.type, state.stride, state.pointer);
+    } else {
+        glVertexAttribPointer(location, state.size, state.type, state.normalized, state.stride, state.pointer);
+    }
+
+    glVertexAttribDivisor(location, state.divisor);
+    glEnableVertexAttribArray(location);
+}
+
+/**
+ * @return count of the vertices which fit in the attribute's buffer
+ */
+uint getVerticesCount(const AttribState &state) {
+    glBindBuffer(GL_COPY_READ_BUFFER, state.buffer);
+
+    GLint size;
+    glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &size);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+    auto offset = static_cast<GLint>(reinterpret_cast<uintptr_t>(state.pointer));
+    auto elementSize = state.size * static_cast<GLint>(getTypeSize(state.type));
+
+    if (size - offset < elementSize)
+        return 0;
+
+    return static_cast<uint>((size - offset - elementSize) / state.stride + 1);
+}
+}
+
+const vector<string>& PreSkinning::getFeedbackVaryings() {
+    using namespace SkinningShader::Vars;
+
+    static const vector<string> varyings {
+        SkinnedPos, SkinnedNormal, SkinnedTangent, SkinnedBitangent
+    };
+
+    return varyings;
+}
+
+PreSkinning::PreSkinning() = default;
+
+PreSkinning::~PreSkinning() {
+    for (auto &entry : m_entries) {
+        glDeleteVertexArrays(1, &entry.inputLayout);
+        glDeleteBuffers(1, &entry.buffer);
+    }
+}
+
+bool PreSkinning::init(const ShaderProgramPtr &program) {
+    GLint varyingsCount = 0;
+    glGetProgramiv(program->getId(), GL_TRANSFORM_FEEDBACK_VARYINGS, &varyingsCount);
+
+    if (varyingsCount != static_cast<GLint>(getFeedbackVaryings().size())) {
+        cerr << "PreSkinning: the skinning program doesn't capture the skinned vertices, pre-skinning is disabled\n";
+        return false;
+    }
+
+    m_program = program;
+
+    return true;
+}
+
+bool PreSkinning::addModel(const ModelPtr &model, uint sourceLayout, const ShaderProgramPtr &sourceProgram,
+                           const vector<LayoutLocations> &targets)
+{
+    if (!m_program)
+        return false;
+
+    auto &shape = model->getShape();
+
+    if (!shape->isBonesPresent())
+        return false;
+
+    for (auto &entry : m_entries) {
+        if (entry.model->getShape() == shape) {
+            cerr << "PreSkinning: shape is shared with another pre-skinned model, model is skipped\n";
+            return false;
+        }
+    }
+
+    auto programId = m_program->getId();
+    auto sourceId = sourceProgram->getId();
+
+    // state of the source layout attributes, which are read by the skinning program
+    vector<AttribState> attribs;
+
+    GLint attribsCount = 0;
+    glGetProgramiv(programId, GL_ACTIVE_ATTRIBUTES, &attribsCount);
+
+    shape->getInputLayout(sourceLayout)->bind();
+
+    for (GLint i = 0; i < attribsCount; i++) {
+        char name[128];
+        GLint size;
+        GLenum type;
+        glGetActiveAttrib(programId, i, sizeof(name), nullptr, &size, &type, name);
+
+        GLint location = glGetAttribLocation(programId, name);
+
+        if (location < 0)
+            continue; // built-in
+
+        GLint sourceLocation = glGetAttribLocation(sourceId, name);
+
+        if (sourceLocation < 0) {
+            cerr << "PreSkinning: attribute " << name << " is not found in the source program\n";
+            return false;
+        }
+
+        // arrays (e.g. bone ids and weights) occupy consecutive locations
+        for (GLint j = 0; j < size; j++) {
+            auto state = readAttrib(sourceLocation + j);
+            state.location = location + j;
+            attribs.emplace_back(state);
+        }
+    }
+
+    Entry entry {model, 0, 0, UINT32_MAX};
+
+    for (auto &state : attribs)
+        if (state.enabled && state.divisor == 0)
+            entry.verticesCount = min(entry.verticesCount, getVerticesCount(state));
+
+    if (entry.verticesCount == UINT32_MAX || entry.verticesCount == 0) {
+        cerr << "PreSkinning: source layout has no vertices\n";
+        return false;
+    }
+
+    glGenVertexArrays(1, &entry.inputLayout);
+    glBindVertexArray(entry.inputLayout);
+
+    for (auto &state : attribs)
+        if (state.enabled)
+            writeAttrib(state.location, state);
+
+    glGenBuffers(1, &entry.buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, entry.buffer);
+    glBufferData(GL_ARRAY_BUFFER, entry.verticesCount * SkinnedStride, nullptr, GL_DYNAMIC_COPY);
+
+    // redirect the shape's layouts to the skinned vertices,
+    // after the original state has been copied
+    for (auto &target : targets) {
+        shape->getInputLayout(target.layoutIndex)->bind();
+
+        const pair<int, uint> redirects[] = {
+            {target.position, 0},
+            {target.normal, 1},
+            {target.tangent, 2},
+            {target.bitangent, 3}
+        };
+
+        for (auto [location, index] : redirects) {
+            if (location < 0)
+                continue;
+
+            auto offset = reinterpret_cast<void*>(static_cast<uintptr_t>(index * sizeof(float[3])));
+
+            glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, SkinnedStride, offset);
+            glVertexAttribDivisor(location, 0);
+            glEnableVertexAttribArray(location);
+        }
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    m_entries.emplace_back(entry);
+
+    return true;
+}
+
+bool PreSkinning::isPreSkinned(const ModelPtr &model) const {
+    return any_of(m_entries.begin(), m_entries.end(), [&](const Entry &entry) {
+        return entry.model == model;
+    });
+}
+
+bool PreSkinning::isEnabled() const {
+    return !m_entries.empty();
+}
+
+void PreSkinning::update(const BonesLinker &linkBones) {
+    if (m_entries.empty())
+        return;
+
+    m_program->bind();
+
+    glEnable(GL_RASTERIZER_DISCARD);
+
+    for (auto &entry : m_entries) {
+        glBindVertexArray(entry.inputLayout);
+
+        linkBones(entry.model);
+
+        glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, entry.buffer);
+        glBeginTransformFeedback(GL_POINTS);
+        glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(entry.verticesCount));
+        glEndTransformFeedback();
+    }
+
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glDisable(GL_RASTERIZER_DISCARD);
+    glBindVertexArray(0);
+
+    m_program->unbind();
+}
+
+const ShaderProgramPtr& PreSkinning::getProgram() const {
+    return m_program;
+}
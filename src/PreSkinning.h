@@ -0,0 +1,91 @@
+#ifndef ALGINE_EXAMPLES_PRESKINNING_H
+#define ALGINE_EXAMPLES_PRESKINNING_H
+
+#include <algine/core/shader/ShaderProgramPtr.h>
+#include <algine/std/model/ModelPtr.h>
+#include <algine/types.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace algine;
+
+/**
+ * Opt-in pre-skinning stage. Positions, normals, tangents and bitangents
+ * of the skinned models are transformed by the bones once per frame and captured
+ * by transform feedback (see Skinning.conf.json). Input layouts of their shapes
+ * are redirected to the captured buffer, so all passes draw them as static
+ * geometry (with <code>preSkinned</code> set) instead of skinning them again.
+ * Each pre-skinned model must have its own shape
+ */
+class PreSkinning {
+public:
+    /**
+     * Locations of the skinned attributes in the input layout of the shape, -1 - not used
+     */
+    struct LayoutLocations {
+        uint layoutIndex;
+        int position = -1;
+        int normal = -1;
+        int tangent = -1;
+        int bitangent = -1;
+    };
+
+    /**
+     * Links the bones of the model to the skinning program, e.g. by <code>BoneSystemManager::linkBuffer</code>
+     */
+    using BonesLinker = std::function<void(ModelPtr &model)>;
+
+public:
+    /**
+     * @return varyings which must be captured by the skinning program
+     */
+    static const std::vector<std::string>& getFeedbackVaryings();
+
+public:
+    PreSkinning();
+    ~PreSkinning();
+
+    PreSkinning(const PreSkinning&) = delete;
+    PreSkinning& operator=(const PreSkinning&) = delete;
+
+    /**
+     * @return false if the program doesn't capture the varyings, e.g. if it
+     * was created by <code>ShaderProgramCreator</code>
+     */
+    bool init(const ShaderProgramPtr &program);
+
+    /**
+     * @param sourceLayout input layout of the shape, which attributes are read by the skinning program
+     * @param sourceProgram program, which locations are used by the source layout. Attributes
+     * of the skinning program are found in it by their names
+     * @param targets input layouts which are redirected to the skinned buffer
+     */
+    bool addModel(const ModelPtr &model, uint sourceLayout, const ShaderProgramPtr &sourceProgram,
+                  const std::vector<LayoutLocations> &targets);
+
+    bool isPreSkinned(const ModelPtr &model) const;
+    bool isEnabled() const;
+
+    /**
+     * Skins all models. Must be called after the bones are uploaded
+     */
+    void update(const BonesLinker &linkBones);
+
+    const ShaderProgramPtr& getProgram() const;
+
+private:
+    struct Entry {
+        ModelPtr model;
+        uint inputLayout; // reads the original buffers
+        uint buffer; // skinned vertices
+        uint verticesCount;
+    };
+
+private:
+    ShaderProgramPtr m_program;
+    std::vector<Entry> m_entries;
+};
+
+#endif //ALGINE_EXAMPLES_PRESKINNING_H
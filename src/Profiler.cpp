@@ -0,0 +1,313 @@
+#include "Profiler.h"
+
+#include <algine/gl.h>
+
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+// max amount of frames waiting for GPU results
+constexpr static usize maxPendingFrames = 4;
+
+Profiler::Profiler(usize framesCount)
+    : m_enabled(false),
+      m_gpuEnabled(true),
+      m_frameActive(false),
+      m_frameIndex(0),
+      m_epoch(Clock::now()),
+      m_gpuEpochCPU(0.0),
+      m_gpuEpoch(0),
+      m_gpuEpochValid(false),
+      m_current(),
+      m_frames(framesCount),
+      m_framesHead(0),
+      m_framesCount(0) {}
+
+Profiler::~Profiler() {
+    resolvePending(true);
+
+    if (!m_freeQueries.empty()) {
+        glDeleteQueries(static_cast<GLsizei>(m_freeQueries.size()), m_freeQueries.data());
+    }
+}
+
+void Profiler::setEnabled(bool enabled) {
+    // keeps already collected frames available for queries
+    if (m_enabled && !enabled)
+        resolvePending(true);
+
+    m_enabled = enabled;
+}
+
+void Profiler::setGPUEnabled(bool enabled) {
+    m_gpuEnabled = enabled;
+}
+
+bool Profiler::isEnabled() const {
+    return m_enabled;
+}
+
+bool Profiler::isGPUEnabled() const {
+    return m_gpuEnabled;
+}
+
+void Profiler::beginFrame() {
+    m_frameActive = m_enabled;
+
+    if (!m_frameActive)
+        return;
+
+    if (m_gpuEnabled && !m_gpuEpochValid) {
+        GLint64 timestamp;
+        glGetInteger64v(GL_TIMESTAMP, &timestamp);
+
+        m_gpuEpoch = timestamp;
+        m_gpuEpochCPU = cpuNow();
+        m_gpuEpochValid = true;
+    }
+
+    m_current.frame.index = m_frameIndex++;
+    m_current.frame.gpu = m_gpuEnabled;
+    m_current.frame.zones.clear();
+    m_current.zoneQueries.clear();
+    m_zoneStack.clear();
+
+    m_current.frame.begin = cpuNow();
+
+    if (m_gpuEnabled) {
+        m_current.frameQueries[0] = queryTimestamp();
+    }
+}
+
+void Profiler::endFrame() {
+    if (!m_frameActive)
+        return;
+
+    while (!m_zoneStack.empty()) {
+        cerr << "Profiler: zone " << m_current.frame.zones[m_zoneStack.back()].name << " was not closed\n";
+        endZone();
+    }
+
+    m_current.frame.end = cpuNow();
+
+    if (m_gpuEnabled) {
+        m_current.frameQueries[1] = queryTimestamp();
+        m_pending.emplace_back(std::move(m_current));
+        resolvePending(m_pending.size() > maxPendingFrames);
+    } else {
+        resolve(m_current);
+    }
+
+    m_current = PendingFrame();
+    m_frameActive = false;
+}
+
+void Profiler::beginZone(const char *name) {
+    if (!m_frameActive)
+        return;
+
+    auto &zones = m_current.frame.zones;
+
+    Zone zone {};
+    zone.name = name;
+    zone.depth = static_cast<uint>(m_zoneStack.size());
+    zone.parent = m_zoneStack.empty() ? NoParent : m_zoneStack.back();
+
+    m_zoneStack.push_back(static_cast<uint>(zones.size()));
+
+    if (m_gpuEnabled)
+        m_current.zoneQueries.push_back(queryTimestamp());
+
+    zone.cpuBegin = cpuNow();
+    zones.emplace_back(zone);
+}
+
+void Profiler::endZone() {
+    if (!m_frameActive || m_zoneStack.empty())
+        return;
+
+    auto &zone = m_current.frame.zones[m_zoneStack.back()];
+    zone.cpuEnd = cpuNow();
+
+    // matched with the zone in resolve()
+    if (m_gpuEnabled)
+        m_current.zoneQueries.push_back(queryTimestamp());
+
+    m_zoneStack.pop_back();
+}
+
+usize Profiler::getFramesCount() const {
+    return m_framesCount;
+}
+
+const Profiler::Frame& Profiler::getFrame(usize index) const {
+    return m_frames[(m_framesHead + m_frames.size() - 1 - index) % m_frames.size()];
+}
+
+double Profiler::getAverageCPUTime(const string &zoneName) const {
+    double sum = 0.0;
+    usize count = 0;
+
+    for (usize i = 0; i < m_framesCount; i++) {
+        for (auto &zone : getFrame(i).zones) {
+            if (zoneName == zone.name) {
+                sum += zone.cpuTime();
+                ++count;
+            }
+        }
+    }
+
+    return count == 0 ? 0.0 : sum / static_cast<double>(count);
+}
+
+double Profiler::getAverageGPUTime(const string &zoneName) const {
+    double sum = 0.0;
+    usize count = 0;
+
+    for (usize i = 0; i < m_framesCount; i++) {
+        auto &frame = getFrame(i);
+
+        if (!frame.gpu)
+            continue;
+
+        for (auto &zone : frame.zones) {
+            if (zoneName == zone.name) {
+                sum += zone.gpuTime();
+                ++count;
+            }
+        }
+    }
+
+    return count == 0 ? 0.0 : sum / static_cast<double>(count);
+}
+
+bool Profiler::dumpChromeTrace(const string &path) const {
+    ofstream out(path);
+
+    if (!out.is_open()) {
+        cerr << "Profiler: can't open " << path << "\n";
+        return false;
+    }
+
+    constexpr int cpuTid = 1;
+    constexpr int gpuTid = 2;
+
+    bool first = true;
+
+    auto writeEvent = [&](const char *name, int tid, double begin, double end) {
+        out << (first ? "\n" : ",\n");
+        out << R"(    {"name": ")" << name << R"(", "ph": "X", "pid": 1, "tid": )" << tid
+            << R"(, "ts": )" << begin * 1000.0 << R"(, "dur": )" << (end - begin) * 1000.0 << "}";
+        first = false;
+    };
+
+    out << R"({"displayTimeUnit": "ms", "traceEvents": [)";
+
+    out << "\n" << R"(    {"name": "thread_name", "ph": "M", "pid": 1, "tid": 1, "args": {"name": "CPU"}},)";
+    out << "\n" << R"(    {"name": "thread_name", "ph": "M", "pid": 1, "tid": 2, "args": {"name": "GPU"}})";
+    first = false;
+
+    for (usize i = m_framesCount; i > 0; i--) {
+        auto &frame = getFrame(i - 1);
+
+        writeEvent("frame", cpuTid, frame.begin, frame.end);
+
+        if (frame.gpu)
+            writeEvent("frame", gpuTid, frame.gpuBegin, frame.gpuEnd);
+
+        for (auto &zone : frame.zones) {
+            writeEvent(zone.name, cpuTid, zone.cpuBegin, zone.cpuEnd);
+
+            if (frame.gpu) {
+                writeEvent(zone.name, gpuTid, zone.gpuBegin, zone.gpuEnd);
+            }
+        }
+    }
+
+    out << "\n]}\n";
+
+    return true;
+}
+
+double Profiler::cpuNow() const {
+    return chrono::duration<double, milli>(Clock::now() - m_epoch).count();
+}
+
+uint Profiler::queryTimestamp() {
+    uint query;
+
+    if (m_freeQueries.empty()) {
+        glGenQueries(1, &query);
+    } else {
+        query = m_freeQueries.back();
+        m_freeQueries.pop_back();
+    }
+
+    glQueryCounter(query, GL_TIMESTAMP);
+
+    return query;
+}
+
+void Profiler::resolve(PendingFrame &pending) {
+    auto &frame = pending.frame;
+
+    if (frame.gpu) {
+        auto getTime = [&](uint query) {
+            GLuint64 timestamp = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &timestamp);
+            m_freeQueries.push_back(query);
+
+            return static_cast<double>(static_cast<int64_t>(timestamp) - m_gpuEpoch) / 1e6 + m_gpuEpochCPU;
+        };
+
+        frame.gpuBegin = getTime(pending.frameQueries[0]);
+        frame.gpuEnd = getTime(pending.frameQueries[1]);
+
+        // zone queries are stored in the order of the calls,
+        // so they must be matched with the zones using the same stack walk
+        vector<uint> stack;
+        uint nextZone = 0;
+
+        for (uint query : pending.zoneQueries) {
+            if (!stack.empty() && (nextZone == frame.zones.size() ||
+                    frame.zones[nextZone].depth <= frame.zones[stack.back()].depth))
+            {
+                frame.zones[stack.back()].gpuEnd = getTime(query);
+                stack.pop_back();
+            } else {
+                frame.zones[nextZone].gpuBegin = getTime(query);
+                stack.push_back(nextZone++);
+            }
+        }
+    }
+
+    m_frames[m_framesHead] = std::move(frame);
+    m_framesHead = (m_framesHead + 1) % m_frames.size();
+
+    if (m_framesCount < m_frames.size()) {
+        ++m_framesCount;
+    }
+}
+
+void Profiler::resolvePending(bool wait) {
+    while (!m_pending.empty()) {
+        auto &pending = m_pending.front();
+
+        if (!wait) {
+            // timestamps are written in order, so if the last
+            // query of the frame is available, all other are available too
+            GLint available = 0;
+            glGetQueryObjectiv(pending.frameQueries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+            if (!available) {
+                break;
+            }
+        }
+
+        resolve(pending);
+        m_pending.pop_front();
+
+        wait = m_pending.size() > maxPendingFrames;
+    }
+}
@@ -0,0 +1,137 @@
+#ifndef ALGINE_EXAMPLES_PROFILER_H
+#define ALGINE_EXAMPLES_PROFILER_H
+
+#include <algine/types.h>
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <chrono>
+#include <cstdint>
+
+using namespace algine;
+
+/**
+ * Hierarchical CPU/GPU profiler. Zones can be nested, the last
+ * <code>framesCount</code> frames are kept in the ring buffer.
+ * GPU time is measured by GL_TIMESTAMP queries, which are read back
+ * a few frames later, so profiling doesn't stall the pipeline.
+ * All times are in ms since profiler creation.
+ */
+class Profiler {
+public:
+    constexpr static uint NoParent = static_cast<uint>(-1);
+
+    struct Zone {
+        const char *name;
+        uint depth;
+        uint parent;
+        double cpuBegin, cpuEnd;
+        double gpuBegin, gpuEnd;
+
+        inline double cpuTime() const { return cpuEnd - cpuBegin; }
+        inline double gpuTime() const { return gpuEnd - gpuBegin; }
+    };
+
+    struct Frame {
+        uint64_t index = 0;
+        double begin = 0.0, end = 0.0;
+        double gpuBegin = 0.0, gpuEnd = 0.0;
+        bool gpu = false;
+        std::vector<Zone> zones;
+    };
+
+public:
+    explicit Profiler(usize framesCount = 120);
+    ~Profiler();
+
+    void setEnabled(bool enabled);
+    void setGPUEnabled(bool enabled);
+
+    bool isEnabled() const;
+    bool isGPUEnabled() const;
+
+    void beginFrame();
+    void endFrame();
+
+    void beginZone(const char *name);
+    void endZone();
+
+    /**
+     * @return amount of completed frames in the ring buffer
+     */
+    usize getFramesCount() const;
+
+    /**
+     * @param index 0 - the latest completed frame
+     */
+    const Frame& getFrame(usize index) const;
+
+    double getAverageCPUTime(const std::string &zoneName) const;
+    double getAverageGPUTime(const std::string &zoneName) const;
+
+    bool dumpChromeTrace(const std::string &path) const;
+
+private:
+    struct PendingFrame {
+        Frame frame;
+        uint frameQueries[2];
+        std::vector<uint> zoneQueries; // begin & end for each zone
+    };
+
+    double cpuNow() const;
+    uint queryTimestamp();
+    void resolve(PendingFrame &pending);
+    void resolvePending(bool wait);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    bool m_enabled;
+    bool m_gpuEnabled;
+    bool m_frameActive;
+    uint64_t m_frameIndex;
+
+    Clock::time_point m_epoch;
+    double m_gpuEpochCPU;
+    int64_t m_gpuEpoch;
+    bool m_gpuEpochValid;
+
+    PendingFrame m_current;
+    std::vector<uint> m_zoneStack;
+    std::deque<PendingFrame> m_pending;
+
+    std::vector<Frame> m_frames;
+    usize m_framesHead;
+    usize m_framesCount;
+
+    std::vector<uint> m_freeQueries;
+};
+
+/**
+ * RAII helper, profiler can be nullptr
+ */
+class ProfileZone {
+public:
+    inline ProfileZone(Profiler *profiler, const char *name)
+        : m_profiler(profiler)
+    {
+        if (m_profiler) {
+            m_profiler->beginZone(name);
+        }
+    }
+
+    inline ~ProfileZone() {
+        if (m_profiler) {
+            m_profiler->endZone();
+        }
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    Profiler *m_profiler;
+};
+
+#endif //ALGINE_EXAMPLES_PROFILER_H
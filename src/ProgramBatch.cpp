@@ -0,0 +1,221 @@
+#include "ProgramBatch.h"
+#include "ProgramCache.h"
+#include "GLExtensions.h"
+
+#include <algine/core/shader/ShaderProgram.h>
+#include <algine/core/shader/ShaderProgramCreator.h>
+#include <algine/core/PtrMaker.h>
+#include <algine/gl.h>
+
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+
+#ifndef GL_COMPLETION_STATUS_KHR
+    #define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+using namespace std;
+
+ProgramBatch::ProgramBatch(JobSystem &jobSystem, ProgramCache *cache)
+    : m_jobSystem(jobSystem),
+      m_cache(cache) {}
+
+void ProgramBatch::setIncludePaths(const vector<string> &paths) {
+    m_includePaths = paths;
+}
+
+void ProgramBatch::add(ShaderProgramPtr &program, const string &configPath) {
+    add(program, configPath, {});
+}
+
+void ProgramBatch::add(ShaderProgramPtr &program, const string &configPath, const vector<string> &feedbackVaryings) {
+    auto &item = *m_items.emplace_back(make_unique<Item>());
+    item.target = &program;
+    item.configPath = configPath;
+    item.source.feedbackVaryings = feedbackVaryings;
+
+    auto loaded = make_shared<promise<bool>>();
+    item.loaded = loaded->get_future();
+
+    m_jobSystem.submit([this, &item, loaded]() {
+        try {
+            loaded->set_value(loadProgramSource(item.configPath, m_includePaths, item.source));
+        } catch (const exception &e) {
+            cerr << "ProgramBatch: " << item.configPath << ": " << e.what() << "\n";
+            loaded->set_value(false);
+        }
+    });
+}
+
+void ProgramBatch::finish() {
+    bool parallel = isParallelCompileSupported();
+
+    if (parallel) {
+        using MaxThreadsFunc = void (*)(GLuint);
+
+        // the driver chooses the number of threads
+        auto maxThreads = reinterpret_cast<MaxThreadsFunc>(glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+
+        if (maxThreads) {
+            maxThreads(0xffffffff);
+        }
+    }
+
+    auto loading = static_cast<uint>(m_items.size());
+    auto remaining = loading;
+
+    while (remaining > 0) {
+        bool progress = false;
+
+        for (auto &item : m_items) {
+            if (item->state == State::Loading) {
+                if (item->loaded.wait_for(chrono::seconds(0)) != future_status::ready)
+                    continue;
+
+                submit(*item);
+
+                --loading;
+                progress = true;
+            }
+
+            if (item->state == State::Linking) {
+                // without the extension status queries block until the program is linked,
+                // so they are deferred until all programs are submitted
+                bool completed = parallel ? isCompleted(*item) : loading == 0;
+
+                if (!completed)
+                    continue;
+
+                complete(*item);
+                progress = true;
+            }
+
+            if (item->state == State::Done && item->target != nullptr) {
+                done(*item);
+                --remaining;
+                progress = true;
+            }
+        }
+
+        // help the workers with the expansion instead of spinning
+        if (!progress && !m_jobSystem.tryRunJob()) {
+            this_thread::yield();
+        }
+    }
+
+    m_items.clear();
+}
+
+const ProgramBatch::Stats& ProgramBatch::getStats() const {
+    return m_stats;
+}
+
+void ProgramBatch::submit(Item &item) {
+    if (!item.loaded.get()) {
+        fallback(item);
+        return;
+    }
+
+    if (m_cache) {
+        if (auto program = m_cache->load(item.source); program != nullptr) {
+            item.program = program;
+            item.state = State::Done;
+            ++m_stats.cached;
+            return;
+        }
+    }
+
+    item.program = PtrMaker::make();
+
+    auto id = item.program->getId();
+
+    for (auto &shader : item.source.shaders) {
+        auto shaderId = glCreateShader(shader.type);
+        auto source = shader.source.c_str();
+
+        glShaderSource(shaderId, 1, &source, nullptr);
+        glCompileShader(shaderId);
+        glAttachShader(id, shaderId);
+
+        item.shaders.emplace_back(shaderId);
+    }
+
+    if (auto &varyings = item.source.feedbackVaryings; !varyings.empty()) {
+        vector<const char*> names;
+
+        for (auto &varying : varyings)
+            names.emplace_back(varying.c_str());
+
+        glTransformFeedbackVaryings(id, static_cast<GLsizei>(names.size()), names.data(), GL_INTERLEAVED_ATTRIBS);
+    }
+
+    glLinkProgram(id);
+
+    item.state = State::Linking;
+}
+
+void ProgramBatch::complete(Item &item) {
+    auto id = item.program->getId();
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(id, GL_LINK_STATUS, &linked);
+
+    if (linked != GL_TRUE) {
+        char log[1024];
+        glGetProgramInfoLog(id, sizeof(log), nullptr, log);
+        cerr << "ProgramBatch: " << item.configPath << " can't be linked, compiling by the engine\n" << log << "\n";
+    }
+
+    for (auto shader : item.shaders) {
+        glDetachShader(id, shader);
+        glDeleteShader(shader);
+    }
+
+    item.shaders.clear();
+
+    if (linked != GL_TRUE) {
+        fallback(item);
+        return;
+    }
+
+    registerPublicProgram(item.program, item.source);
+
+    if (m_cache)
+        m_cache->store(item.source, item.program);
+
+    item.state = State::Done;
+
+    ++m_stats.compiled;
+}
+
+void ProgramBatch::fallback(Item &item) {
+    ShaderProgramCreator creator;
+    creator.importFromFile(item.configPath);
+
+    item.program = creator.create();
+    item.state = State::Done;
+
+    ++m_stats.fallback;
+}
+
+void ProgramBatch::done(Item &item) {
+    // not deferred to the first use: the engine's setters and getLocation read the
+    // locations loaded here, and the first use of a program is inside the engine.
+    // It runs while the other programs of the batch are still compiling
+    item.program->loadActiveLocations();
+
+    *item.target = item.program;
+    item.target = nullptr;
+}
+
+bool ProgramBatch::isCompleted(const Item &item) {
+    GLint completed = GL_FALSE;
+    glGetProgramiv(item.program->getId(), GL_COMPLETION_STATUS_KHR, &completed);
+
+    return completed == GL_TRUE;
+}
+
+bool ProgramBatch::isParallelCompileSupported() {
+    return isExtensionSupported("GL_KHR_parallel_shader_compile");
+}
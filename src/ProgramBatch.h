@@ -0,0 +1,98 @@
+#ifndef ALGINE_EXAMPLES_PROGRAMBATCH_H
+#define ALGINE_EXAMPLES_PROGRAMBATCH_H
+
+#include <algine/core/shader/ShaderProgramPtr.h>
+#include <algine/types.h>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <future>
+
+#include "JobSystem.h"
+#include "ShaderSource.h"
+
+using namespace algine;
+
+class ProgramCache;
+
+/**
+ * Creates several programs at once. Sources are expanded by the workers
+ * of the job system; compiles and links of all programs are submitted
+ * before any of their statuses is queried, so the driver can overlap them.
+ * With <code>KHR_parallel_shader_compile</code> completion is polled
+ * (<code>GL_COMPLETION_STATUS_KHR</code>) and locations of each program
+ * are loaded as soon as it is linked, while the rest are still compiling.
+ * Programs which fail to compile this way are created by
+ * <code>ShaderProgramCreator</code>, which reports the errors
+ */
+class ProgramBatch {
+public:
+    struct Stats {
+        uint compiled = 0;
+        uint cached = 0;
+        uint fallback = 0;
+    };
+
+public:
+    explicit ProgramBatch(JobSystem &jobSystem, ProgramCache *cache = nullptr);
+
+    /**
+     * @param paths the same paths as passed to <code>ShaderCreator::setGlobalIncludePaths</code>
+     */
+    void setIncludePaths(const std::vector<std::string> &paths);
+
+    /**
+     * Starts loading of the config (*.conf.json).
+     * <code>program</code> is assigned by <code>finish</code>, so it must outlive the batch
+     */
+    void add(ShaderProgramPtr &program, const std::string &configPath);
+
+    /**
+     * Same as above, <code>feedbackVaryings</code> are captured by transform feedback
+     * (GL_INTERLEAVED_ATTRIBS). They are set before linking, so the programs created
+     * by <code>ShaderProgramCreator</code> on fallback don't capture them
+     */
+    void add(ShaderProgramPtr &program, const std::string &configPath, const std::vector<std::string> &feedbackVaryings);
+
+    /**
+     * Waits for all programs and loads their active locations
+     */
+    void finish();
+
+    const Stats& getStats() const;
+
+private:
+    enum class State {
+        Loading,
+        Linking,
+        Done
+    };
+
+    struct Item {
+        ShaderProgramPtr *target;
+        std::string configPath;
+        ProgramSource source;
+        std::future<bool> loaded;
+        ShaderProgramPtr program;
+        std::vector<uint> shaders;
+        State state = State::Loading;
+    };
+
+    void submit(Item &item);
+    void complete(Item &item);
+    void fallback(Item &item);
+    void done(Item &item);
+
+    static bool isCompleted(const Item &item);
+    static bool isParallelCompileSupported();
+
+private:
+    JobSystem &m_jobSystem;
+    ProgramCache *m_cache;
+    std::vector<std::string> m_includePaths;
+    std::vector<std::unique_ptr<Item>> m_items;
+    Stats m_stats;
+};
+
+#endif //ALGINE_EXAMPLES_PROGRAMBATCH_H
@@ -0,0 +1,221 @@
+#include "ProgramCache.h"
+#include "ShaderSource.h"
+
+#include <algine/core/shader/ShaderProgram.h>
+#include <algine/core/shader/ShaderProgramCreator.h>
+#include <algine/core/PtrMaker.h>
+#include <algine/gl.h>
+
+#include <filesystem>
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+
+using namespace std;
+
+namespace {
+constexpr uint32_t Magic = 0x43425041; // "APBC"
+constexpr uint32_t Version = 1;
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t format;
+    uint32_t length;
+};
+
+uint64_t fnv1a(uint64_t hash, const char *str) {
+    // including the terminator, so {"ab", "c"} and {"a", "bc"} give different keys
+    auto length = strlen(str) + 1;
+
+    for (usize i = 0; i < length; i++) {
+        hash ^= static_cast<uint8_t>(str[i]);
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+}
+
+ProgramCache::ProgramCache(string directory)
+    : m_directory(std::move(directory)),
+      m_driverHash(0),
+      m_supported(-1) {}
+
+void ProgramCache::setIncludePaths(const vector<string> &paths) {
+    m_includePaths = paths;
+}
+
+ShaderProgramPtr ProgramCache::create(const string &configPath) {
+    ProgramSource source;
+
+    // sources which can't be expanded are left to the engine,
+    // it reports the errors itself
+    bool cacheable = isSupported() && loadProgramSource(configPath, m_includePaths, source);
+
+    if (cacheable) {
+        if (auto program = load(source); program != nullptr) {
+            return program;
+        }
+    } else {
+        ++m_stats.misses;
+    }
+
+    ShaderProgramCreator creator;
+    creator.importFromFile(configPath);
+
+    auto program = creator.create();
+
+    if (cacheable)
+        store(source, program);
+
+    return program;
+}
+
+ShaderProgramPtr ProgramCache::load(const ProgramSource &source) {
+    if (!isSupported()) {
+        ++m_stats.misses;
+        return nullptr;
+    }
+
+    auto program = read(getKey(source));
+
+    if (program == nullptr) {
+        ++m_stats.misses;
+        return nullptr;
+    }
+
+    registerPublicProgram(program, source);
+
+    ++m_stats.hits;
+
+    return program;
+}
+
+void ProgramCache::store(const ProgramSource &source, const ShaderProgramPtr &program) {
+    if (isSupported()) {
+        write(getKey(source), program);
+    }
+}
+
+const ProgramCache::Stats& ProgramCache::getStats() const {
+    return m_stats;
+}
+
+bool ProgramCache::isSupported() {
+    if (m_supported == -1) {
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+
+        m_supported = formats > 0;
+
+        if (!m_supported) {
+            cerr << "ProgramCache: program binaries are not supported by the driver\n";
+        }
+    }
+
+    return m_supported == 1;
+}
+
+uint64_t ProgramCache::getKey(const ProgramSource &source) {
+    if (m_driverHash == 0) {
+        uint64_t hash = 14695981039346656037ull;
+
+        for (auto name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+            auto str = reinterpret_cast<const char*>(glGetString(name));
+            hash = fnv1a(hash, str ? str : "");
+        }
+
+        m_driverHash = hash;
+    }
+
+    return source.hash(m_driverHash ^ Version);
+}
+
+string ProgramCache::getPath(uint64_t key) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+
+    return m_directory + "/" + name;
+}
+
+ShaderProgramPtr ProgramCache::read(uint64_t key) {
+    auto path = getPath(key);
+
+    ifstream file(path, ios::binary);
+
+    if (!file.is_open())
+        return nullptr;
+
+    Header header {};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    if (!file || header.magic != Magic || header.version != Version || header.key != key) {
+        cerr << "ProgramCache: " << path << " is invalid\n";
+        return nullptr;
+    }
+
+    vector<char> binary(header.length);
+    file.read(binary.data(), header.length);
+
+    if (!file) {
+        cerr << "ProgramCache: " << path << " is truncated\n";
+        return nullptr;
+    }
+
+    ShaderProgramPtr program = PtrMaker::make();
+    glProgramBinary(program->getId(), header.format, binary.data(), static_cast<GLsizei>(header.length));
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program->getId(), GL_LINK_STATUS, &linked);
+
+    // the driver may reject binaries even if its identity is the same
+    // (e.g. different hardware configuration), they are replaced then
+    if (linked != GL_TRUE) {
+        cerr << "ProgramCache: " << path << " was rejected by the driver\n";
+        return nullptr;
+    }
+
+    return program;
+}
+
+void ProgramCache::write(uint64_t key, const ShaderProgramPtr &program) {
+    GLint length = 0;
+    glGetProgramiv(program->getId(), GL_PROGRAM_BINARY_LENGTH, &length);
+
+    if (length <= 0)
+        return;
+
+    Header header {Magic, Version, key, 0, static_cast<uint32_t>(length)};
+
+    vector<char> binary(length);
+    glGetProgramBinary(program->getId(), length, nullptr, &header.format, binary.data());
+
+    error_code error;
+    filesystem::create_directories(m_directory, error);
+
+    // written to the temporary file first, so the concurrently
+    // started processes never read a partially written binary
+    auto path = getPath(key);
+    auto tmpPath = path + ".tmp";
+
+    {
+        ofstream file(tmpPath, ios::binary);
+
+        if (!file.is_open()) {
+            cerr << "ProgramCache: can't write " << tmpPath << "\n";
+            return;
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(binary.data(), length);
+    }
+
+    filesystem::rename(tmpPath, path, error);
+
+    if (error) {
+        cerr << "ProgramCache: can't write " << path << ": " << error.message() << "\n";
+    }
+}
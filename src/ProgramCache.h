@@ -0,0 +1,74 @@
+#ifndef ALGINE_EXAMPLES_PROGRAMCACHE_H
+#define ALGINE_EXAMPLES_PROGRAMCACHE_H
+
+#include <algine/core/shader/ShaderProgramPtr.h>
+#include <algine/types.h>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+using namespace algine;
+
+struct ProgramSource;
+
+/**
+ * On-disk cache of the linked program binaries (<code>glGetProgramBinary</code>).
+ * Key covers the fully expanded sources with definitions and params
+ * (see <code>ProgramSource</code>) and the driver identity (vendor, renderer, version),
+ * so any change of them invalidates the binary.
+ * On miss, or if the driver rejects the binary, the program is compiled
+ * by <code>ShaderProgramCreator</code> and its binary is stored
+ */
+class ProgramCache {
+public:
+    struct Stats {
+        uint hits = 0;
+        uint misses = 0;
+    };
+
+public:
+    explicit ProgramCache(std::string directory = "cache/programs");
+
+    /**
+     * @param paths the same paths as passed to <code>ShaderCreator::setGlobalIncludePaths</code>
+     */
+    void setIncludePaths(const std::vector<std::string> &paths);
+
+    /**
+     * Creates the program from the config (*.conf.json). Public programs
+     * are registered by their names in both cases, so they can be referenced
+     * by the input layout locations
+     */
+    ShaderProgramPtr create(const std::string &configPath);
+
+    /**
+     * @return linked program, or nullptr if there is no valid binary for the sources
+     */
+    ShaderProgramPtr load(const ProgramSource &source);
+
+    /**
+     * Stores binary of the program linked from the sources
+     */
+    void store(const ProgramSource &source, const ShaderProgramPtr &program);
+
+    bool isSupported();
+
+    const Stats& getStats() const;
+
+private:
+    uint64_t getKey(const ProgramSource &source);
+    std::string getPath(uint64_t key) const;
+
+    ShaderProgramPtr read(uint64_t key);
+    void write(uint64_t key, const ShaderProgramPtr &program);
+
+private:
+    std::string m_directory;
+    std::vector<std::string> m_includePaths;
+    uint64_t m_driverHash;
+    int m_supported;
+    Stats m_stats;
+};
+
+#endif //ALGINE_EXAMPLES_PROGRAMCACHE_H
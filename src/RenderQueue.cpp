@@ -0,0 +1,216 @@
+#include "RenderQueue.h"
+
+#include "ColorShader.h"
+#include "InstancedModelGroup.h"
+#include "UniformCache.h"
+
+#include <algine/core/Engine.h>
+#include <algine/core/shader/ShaderProgram.h>
+
+#include <algine/std/model/Shape.h>
+#include <algine/std/model/Model.h>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+static uint32_t depthBits(float depth) {
+    // bits of the non-negative float have the same order as its values
+    depth = max(depth, 0.0f);
+
+    uint32_t bits;
+    memcpy(&bits, &depth, sizeof(bits));
+
+    return bits;
+}
+
+// key layout: | program: 8 | input layout: 8 | material: 16 | depth: 32 |
+constexpr static uint64_t packKey(uint program, uint layout, uint material, uint32_t depth) {
+    return (static_cast<uint64_t>(program & 0xff) << 56) |
+           (static_cast<uint64_t>(layout & 0xff) << 48) |
+           (static_cast<uint64_t>(material & 0xffff) << 32) |
+           depth;
+}
+
+bool RenderQueue::MaterialState::operator==(const MaterialState &other) const {
+    return memcmp(textures, other.textures, sizeof(textures)) == 0 &&
+           memcmp(values, other.values, sizeof(values)) == 0;
+}
+
+void RenderQueue::setProgram(UniformCache &program) {
+    m_program = &program;
+}
+
+void RenderQueue::add(const ModelPtr &model, uint layoutIndex, usize meshIndex, float depth) {
+    add(model, nullptr, layoutIndex, meshIndex, depth);
+}
+
+void RenderQueue::add(InstancedModelGroup *group, uint layoutIndex, usize meshIndex, float depth) {
+    add(group->getModels().front(), group, layoutIndex, meshIndex, depth);
+}
+
+void RenderQueue::add(const ModelPtr &model, InstancedModelGroup *group, uint layoutIndex, usize meshIndex, float depth) {
+    auto &shape = model->getShape();
+    auto &mesh = shape->getMeshes()[meshIndex];
+    auto material = getMaterials(shape)[meshIndex];
+    // groups bind their own input layouts (with the instance attributes)
+    auto layout = getLayoutId(group ? static_cast<const void*>(group) : shape->getInputLayout(layoutIndex).get());
+
+    Item item;
+    item.key = packKey(m_program->getProgram()->getId(), layout, material, depthBits(depth));
+    item.model = model;
+    item.group = group;
+    item.layoutIndex = layoutIndex;
+    item.start = mesh.start;
+    item.count = mesh.count;
+    item.material = material;
+
+    m_items.emplace_back(std::move(item));
+}
+
+void RenderQueue::submit(const ModelChangeCallback &onModelChange) {
+    using namespace ColorShader::Vars;
+
+    m_stats = Stats();
+
+    sort(m_items.begin(), m_items.end(), [](const Item &lhs, const Item &rhs) {
+        return lhs.key < rhs.key;
+    });
+
+    // bound state is unknown before the submission,
+    // since the slots are shared with other passes
+    // the layout actually bound: the shape's one, or the group's one with its index
+    const void *boundLayout = nullptr;
+    uint boundLayoutIndex = 0;
+    const void *boundModel = nullptr; // model or instanced group
+    Texture2D *boundTextures[TexturesCount] {};
+
+    auto countUniform = [this](bool sent) {
+        if (sent) {
+            ++m_stats.uniformSets;
+        } else {
+            ++m_stats.uniformSetsSkipped;
+        }
+    };
+
+    for (auto &item : m_items) {
+        auto &layout = item.model->getShape()->getInputLayout(item.layoutIndex);
+        auto layoutOwner = item.group ? static_cast<const void*>(item.group) : layout.get();
+        auto layoutIndex = item.group ? item.layoutIndex : 0;
+
+        if (layoutOwner != boundLayout || layoutIndex != boundLayoutIndex) {
+            if (item.group) {
+                item.group->bind(item.layoutIndex);
+            } else {
+                layout->bind();
+            }
+
+            boundLayout = layoutOwner;
+            boundLayoutIndex = layoutIndex;
+            ++m_stats.layoutBinds;
+        } else {
+            ++m_stats.layoutBindsSkipped;
+        }
+
+        const void *model = item.group ? static_cast<const void*>(item.group) : item.model.get();
+
+        if (model != boundModel) {
+            onModelChange(item.model, item.group != nullptr);
+            boundModel = model;
+            ++m_stats.modelChanges;
+        }
+
+        auto &material = m_materials[item.material];
+
+        for (uint slot = 0; slot < TexturesCount; slot++) {
+            if (material.textures[slot] != boundTextures[slot]) {
+                material.textures[slot]->use(slot);
+                boundTextures[slot] = material.textures[slot];
+                ++m_stats.textureBinds;
+            } else {
+                ++m_stats.textureBindsSkipped;
+            }
+        }
+
+        countUniform(m_program->set<AmbientStrength>(material.values[0]));
+        countUniform(m_program->set<DiffuseStrength>(material.values[1]));
+        countUniform(m_program->set<SpecularStrength>(material.values[2]));
+        countUniform(m_program->set<Shininess>(material.values[3]));
+
+        if (item.group) {
+            item.group->drawElements(item.start, item.count);
+        } else {
+            Engine::drawElements(item.start, item.count);
+        }
+
+        ++m_stats.drawCalls;
+    }
+}
+
+void RenderQueue::clear() {
+    m_items.clear();
+}
+
+const RenderQueue::Stats& RenderQueue::getStats() const {
+    return m_stats;
+}
+
+const vector<uint>& RenderQueue::getMaterials(const ShapePtr &shape) {
+    if (auto it = m_shapeMaterials.find(shape.get()); it != m_shapeMaterials.end())
+        return it->second;
+
+    auto &ids = m_shapeMaterials[shape.get()];
+
+    auto defaultTexture = &*Engine::defaultTexture2D();
+
+    auto getTexture = [&](const algine::Material &material, const char *name) -> Texture2D* {
+        auto texture = material.getTexture2D(name, nullptr);
+        return texture != nullptr ? texture.get() : defaultTexture;
+    };
+
+    for (auto &mesh : shape->getMeshes()) {
+        using M = algine::Material;
+
+        auto &source = mesh.material;
+
+        MaterialState material {};
+        material.textures[0] = getTexture(source, M::AmbientTexture);
+        material.textures[1] = getTexture(source, M::DiffuseTexture);
+        material.textures[2] = getTexture(source, M::SpecularTexture);
+        material.textures[3] = getTexture(source, M::NormalTexture);
+        material.textures[4] = getTexture(source, M::ReflectionTexture);
+        material.textures[5] = getTexture(source, M::JitterTexture);
+        material.values[0] = source.getFloat(M::AmbientStrength, 0.01f);
+        material.values[1] = source.getFloat(M::DiffuseStrength, 1.0f);
+        material.values[2] = source.getFloat(M::SpecularStrength, 1.0f);
+        material.values[3] = source.getFloat(M::Shininess, 0.01f);
+
+        ids.push_back(getMaterialId(material));
+    }
+
+    return ids;
+}
+
+uint RenderQueue::getMaterialId(const MaterialState &material) {
+    auto it = find(m_materials.begin(), m_materials.end(), material);
+
+    if (it != m_materials.end())
+        return static_cast<uint>(it - m_materials.begin());
+
+    m_materials.emplace_back(material);
+
+    return static_cast<uint>(m_materials.size() - 1);
+}
+
+uint RenderQueue::getLayoutId(const void *layout) {
+    auto it = m_layouts.find(layout);
+
+    if (it != m_layouts.end())
+        return it->second;
+
+    auto id = static_cast<uint>(m_layouts.size());
+    m_layouts[layout] = id;
+
+    return id;
+}
@@ -0,0 +1,107 @@
+#ifndef ALGINE_EXAMPLES_RENDERQUEUE_H
+#define ALGINE_EXAMPLES_RENDERQUEUE_H
+
+#include <algine/std/model/ModelPtr.h>
+#include <algine/std/model/ShapePtr.h>
+#include <algine/core/texture/Texture2D.h>
+
+#include <glm/vec3.hpp>
+
+#include <unordered_map>
+#include <functional>
+#include <vector>
+#include <cstdint>
+
+using namespace algine;
+
+class InstancedModelGroup;
+class UniformCache;
+
+/**
+ * Collects draw items and submits them sorted by the key packed from
+ * program, input layout, material and depth (front to back).
+ * Submission skips redundant input layout, texture and uniform changes.
+ */
+class RenderQueue {
+public:
+    constexpr static uint TexturesCount = 6;
+    constexpr static uint ValuesCount = 4;
+
+    struct Stats {
+        uint drawCalls = 0;
+        uint layoutBinds = 0, layoutBindsSkipped = 0;
+        uint textureBinds = 0, textureBindsSkipped = 0;
+        uint uniformSets = 0, uniformSetsSkipped = 0;
+        uint modelChanges = 0;
+
+        inline uint getStateChangesSaved() const {
+            return layoutBindsSkipped + textureBindsSkipped + uniformSetsSkipped;
+        }
+    };
+
+    /**
+     * Called when the model of the next item differs from the previous one,
+     * e.g. to link bones and to update matrices.
+     * For the instanced groups <code>instanced</code> is true and
+     * <code>model</code> is the first model of the group; model matrix must be identity
+     */
+    using ModelChangeCallback = std::function<void(ModelPtr &model, bool instanced)>;
+
+public:
+    /**
+     * Material values are set through the uniform cache of the program,
+     * so they are not sent again if they are unchanged since the previous submission
+     */
+    void setProgram(UniformCache &program);
+
+    /**
+     * @param layoutIndex index of the shape's input layout
+     * @param meshIndex index of the shape's mesh
+     * @param depth distance to the camera, used for front to back ordering
+     */
+    void add(const ModelPtr &model, uint layoutIndex, usize meshIndex, float depth);
+
+    /**
+     * Adds the mesh of all instances packed by the last <code>InstancedModelGroup::update</code>
+     */
+    void add(InstancedModelGroup *group, uint layoutIndex, usize meshIndex, float depth);
+
+    void submit(const ModelChangeCallback &onModelChange);
+
+    void clear();
+
+    const Stats& getStats() const;
+
+private:
+    struct MaterialState {
+        Texture2D *textures[TexturesCount];
+        float values[ValuesCount];
+
+        bool operator==(const MaterialState &other) const;
+    };
+
+    struct Item {
+        uint64_t key;
+        ModelPtr model;
+        InstancedModelGroup *group;
+        uint layoutIndex;
+        uint start, count;
+        uint material;
+    };
+
+    void add(const ModelPtr &model, InstancedModelGroup *group, uint layoutIndex, usize meshIndex, float depth);
+
+    const std::vector<uint>& getMaterials(const ShapePtr &shape);
+    uint getMaterialId(const MaterialState &material);
+    uint getLayoutId(const void *layout);
+
+private:
+    UniformCache *m_program = nullptr;
+    std::vector<Item> m_items;
+    std::vector<MaterialState> m_materials;
+    std::unordered_map<const void*, uint> m_layouts;
+    std::unordered_map<const void*, std::vector<uint>> m_shapeMaterials; // material ids of the shape meshes
+    Stats m_stats;
+};
+
+#endif //ALGINE_EXAMPLES_RENDERQUEUE_H
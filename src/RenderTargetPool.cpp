@@ -0,0 +1,212 @@
+#include "RenderTargetPool.h"
+
+#include <algine/core/framebuffer/Framebuffer.h>
+#include <algine/core/texture/Texture2D.h>
+#include <algine/core/PtrMaker.h>
+#include <algine/gl.h>
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+// rounded up, so the scaled targets cover the render size
+uint scaleSize(uint size, float scale) {
+    return max(static_cast<uint>(ceil(static_cast<float>(size) * scale)), 1u);
+}
+
+uint toBucket(uint size) {
+    return (size + RenderTargetPool::BucketSize - 1) / RenderTargetPool::BucketSize * RenderTargetPool::BucketSize;
+}
+}
+
+RenderTargetPool::Target RenderTargetPool::create(const string &name, uint format, float scale) {
+    TargetData target;
+    target.name = name;
+    target.format = format;
+    target.scale = scale;
+
+    m_targets.emplace_back(target);
+
+    return static_cast<Target>(m_targets.size() - 1);
+}
+
+void RenderTargetPool::addPass(const string &name, initializer_list<Target> reads, initializer_list<Target> writes) {
+    auto pass = static_cast<int>(m_passes.size());
+
+    m_passes.emplace_back(name);
+
+    for (auto target : reads)
+        use(target, pass, false);
+
+    for (auto target : writes)
+        use(target, pass, true);
+}
+
+void RenderTargetPool::compile() {
+    m_textures.clear();
+
+    vector<Target> order(m_targets.size());
+    iota(order.begin(), order.end(), 0);
+
+    // targets not used by any pass live during the whole frame
+    for (auto &target : m_targets) {
+        if (target.first < 0) {
+            target.first = 0;
+            target.last = static_cast<int>(m_passes.size());
+        }
+    }
+
+    // greedy interval partitioning: by the first use, into the texture
+    // which was released the earliest, is optimal for the intervals
+    stable_sort(order.begin(), order.end(), [this](Target lhs, Target rhs) {
+        return m_targets[lhs].first < m_targets[rhs].first;
+    });
+
+    for (auto index : order) {
+        auto &target = m_targets[index];
+
+        int best = -1;
+
+        for (uint i = 0; i < m_textures.size(); i++) {
+            auto &texture = m_textures[i];
+
+            if (texture.format != target.format || texture.scale != target.scale || texture.last >= target.first)
+                continue;
+
+            if (best < 0 || texture.last < m_textures[best].last) {
+                best = static_cast<int>(i);
+            }
+        }
+
+        if (best < 0) {
+            TextureData texture;
+            texture.format = target.format;
+            texture.scale = target.scale;
+
+            PtrMaker::create(texture.texture, texture.framebuffer);
+
+            if (target.format != DefaultFormat)
+                texture.texture->setFormat(target.format);
+
+            texture.texture->setParams(Texture2D::defaultParams());
+
+            texture.framebuffer->bind();
+            texture.framebuffer->attachTexture(texture.texture, Framebuffer::ColorAttachmentZero);
+            texture.framebuffer->unbind();
+
+            m_textures.emplace_back(texture);
+            best = static_cast<int>(m_textures.size() - 1);
+        }
+
+        m_textures[best].last = target.last;
+        target.texture = static_cast<uint>(best);
+    }
+
+    m_stats.targets = static_cast<uint>(m_targets.size());
+    m_stats.textures = static_cast<uint>(m_textures.size());
+
+    // allocated by the next update
+    m_width = m_height = 0;
+}
+
+void RenderTargetPool::setWindowSize(uint width, uint height) {
+    m_windowWidth = width;
+    m_windowHeight = height;
+    m_stableFrames = 0;
+}
+
+bool RenderTargetPool::update() {
+    uint width = m_windowWidth;
+    uint height = m_windowHeight;
+
+    // the first allocation is exact
+    if (m_width != 0 && (width != m_width || height != m_height) && ++m_stableFrames < SettleFrames) {
+        width = toBucket(width);
+        height = toBucket(height);
+    }
+
+    if (width == m_width && height == m_height)
+        return false;
+
+    resize(width, height);
+
+    return true;
+}
+
+const Texture2DPtr& RenderTargetPool::get(Target target) const {
+    return m_textures[m_targets[target].texture].texture;
+}
+
+const FramebufferPtr& RenderTargetPool::getFramebuffer(Target target) const {
+    return m_textures[m_targets[target].texture].framebuffer;
+}
+
+uint RenderTargetPool::getWidth() const {
+    return m_width;
+}
+
+uint RenderTargetPool::getHeight() const {
+    return m_height;
+}
+
+const RenderTargetPool::Stats& RenderTargetPool::getStats() const {
+    return m_stats;
+}
+
+void RenderTargetPool::use(Target target, int pass, bool write) {
+    if (target == None)
+        return;
+
+    auto &data = m_targets[target];
+
+    if (!write && !data.written)
+        cerr << "RenderTargetPool: " << data.name << " is read by " << m_passes[pass] << " before it's written\n";
+
+    if (data.first < 0)
+        data.first = pass;
+
+    data.last = pass;
+    data.written |= write;
+}
+
+void RenderTargetPool::resize(uint width, uint height) {
+    m_width = width;
+    m_height = height;
+
+    m_stats.bytes = 0;
+    m_stats.unaliasedBytes = 0;
+
+    for (auto &texture : m_textures) {
+        auto w = scaleSize(width, texture.scale);
+        auto h = scaleSize(height, texture.scale);
+
+        texture.framebuffer->resizeAttachments(w, h);
+
+        m_stats.bytes += static_cast<usize>(w) * h * getBytesPerPixel(texture.format);
+    }
+
+    for (auto &target : m_targets) {
+        auto w = scaleSize(width, target.scale);
+        auto h = scaleSize(height, target.scale);
+
+        m_stats.unaliasedBytes += static_cast<usize>(w) * h * getBytesPerPixel(target.format);
+    }
+
+    ++m_stats.reallocations;
+}
+
+uint RenderTargetPool::getBytesPerPixel(uint format) {
+    switch (format) {
+        case GL_R16F: return 2;
+        case GL_RG16F:
+        case GL_RG16: return 4;
+        case GL_RGB16F: return 6;
+        case GL_RGBA16F:
+        case GL_RGBA16: return 8;
+        default: return 4; // RGB(A)8, padded
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef ALGINE_EXAMPLES_RENDERTARGETPOOL_H
+#define ALGINE_EXAMPLES_RENDERTARGETPOOL_H
+
+#include <algine/core/framebuffer/FramebufferPtr.h>
+#include <algine/core/texture/Texture2DPtr.h>
+#include <algine/types.h>
+
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+using namespace algine;
+
+/**
+ * Transient render targets of the post-processing chain. Targets are declared with
+ * a format and a scale of the render size, then the passes declare which targets
+ * they read and write, in the frame order. <code>compile</code> computes the lifetime
+ * of each target (from the first to the last pass using it) and assigns the targets with
+ * the same format and scale, which lifetimes don't overlap, to one texture.
+ * While the window size keeps changing, the render size follows it in buckets, so interactive
+ * resizing reallocates the textures once per bucket instead of every event; the exact size
+ * is applied when it hasn't changed for <code>SettleFrames</code> frames.
+ * Textures are resized in place, so the framebuffers they are attached to stay valid
+ */
+class RenderTargetPool {
+public:
+    using Target = uint;
+
+    struct Stats {
+        uint targets = 0;
+        uint textures = 0;
+        usize bytes = 0; // estimated, at the current render size
+        usize unaliasedBytes = 0; // if each target had its own texture
+        uint reallocations = 0;
+    };
+
+    static constexpr Target None = ~0u;
+    static constexpr uint DefaultFormat = 0; // the default format of Texture2D
+    static constexpr uint BucketSize = 128;
+    static constexpr uint SettleFrames = 15;
+
+public:
+    Target create(const std::string &name, uint format, float scale = 1.0f);
+
+    /**
+     * Targets which are <code>None</code> are skipped
+     */
+    void addPass(const std::string &name, std::initializer_list<Target> reads, std::initializer_list<Target> writes);
+
+    /**
+     * Assigns the textures to the targets. Must be called after all passes are added
+     */
+    void compile();
+
+    void setWindowSize(uint width, uint height);
+
+    /**
+     * Must be called once per frame, before rendering
+     * @return true if the render size has changed
+     */
+    bool update();
+
+    /**
+     * Textures and framebuffers are shared by the aliased targets
+     */
+    const Texture2DPtr& get(Target target) const;
+    const FramebufferPtr& getFramebuffer(Target target) const;
+
+    uint getWidth() const;
+    uint getHeight() const;
+
+    const Stats& getStats() const;
+
+private:
+    struct TargetData {
+        std::string name;
+        uint format;
+        float scale;
+        int first = -1; // pass
+        int last = -1;
+        bool written = false;
+        uint texture = 0;
+    };
+
+    struct TextureData {
+        uint format;
+        float scale;
+        int last; // pass of the last target
+        Texture2DPtr texture;
+        FramebufferPtr framebuffer;
+    };
+
+    void use(Target target, int pass, bool write);
+    void resize(uint width, uint height);
+
+    static uint getBytesPerPixel(uint format);
+
+private:
+    std::vector<TargetData> m_targets;
+    std::vector<TextureData> m_textures;
+    std::vector<std::string> m_passes;
+    uint m_windowWidth = 0, m_windowHeight = 0;
+    uint m_width = 0, m_height = 0;
+    uint m_stableFrames = 0;
+    Stats m_stats;
+};
+
+#endif //ALGINE_EXAMPLES_RENDERTARGETPOOL_H
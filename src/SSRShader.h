@@ -0,0 +1,21 @@
+#ifndef SSRSHADER_H
+#define SSRSHADER_H
+
+#define constant(name, val) constexpr char name[] = val;
+
+namespace SSRShader::Vars {
+constant(BaseImage, "baseImage")
+constant(NormalMap, "normalMap")
+constant(SSRValuesMap, "ssrValuesMap")
+constant(PositionMap, "positionMap")
+constant(DepthMap, "depthMap")
+constant(MinReflectionStrength, "minReflectionStrength")
+constant(HiZMap, "hiZMap")
+constant(HiZLevels, "hiZLevels")
+constant(TraceScale, "traceScale")
+constant(HitMap, "hitMap")
+}
+
+#undef constant
+
+#endif //SSRSHADER_H
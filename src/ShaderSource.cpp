@@ -0,0 +1,291 @@
+#include "ShaderSource.h"
+
+#include <algine/core/shader/ShaderProgram.h>
+#include <algine/gl.h>
+
+#include <nlohmann/json.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <set>
+
+using namespace std;
+using json = nlohmann::json;
+
+namespace {
+uint64_t fnv1a(uint64_t hash, const void *data, usize size) {
+    auto bytes = static_cast<const uint8_t*>(data);
+
+    for (usize i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+bool readFile(const string &path, string &content) {
+    ifstream file(path, ios::binary);
+
+    if (!file.is_open())
+        return false;
+
+    stringstream stream;
+    stream << file.rdbuf();
+    content = stream.str();
+
+    return true;
+}
+
+bool fileExists(const string &path) {
+    return ifstream(path).good();
+}
+
+string getDirectory(const string &path) {
+    auto pos = path.find_last_of("/\\");
+    return pos == string::npos ? string() : path.substr(0, pos + 1);
+}
+
+class Expander {
+public:
+    explicit Expander(const vector<string> &includePaths)
+        : m_includePaths(includePaths) {}
+
+    /**
+     * Resolves <code>@algine/</code> paths, the config-relative paths and
+     * the include names, which may omit the <code>.glsl</code> extension
+     */
+    string resolve(const string &name, const string &dir) const {
+        constexpr char algine[] = "@algine/";
+
+        vector<string> bases;
+
+        if (name.compare(0, sizeof(algine) - 1, algine) == 0) {
+            auto path = name.substr(sizeof(algine) - 1);
+
+            for (auto &base : m_includePaths) {
+                for (auto &candidate : {base + path, base + "shaders/" + path}) {
+                    if (fileExists(candidate)) {
+                        return candidate;
+                    }
+                }
+            }
+
+            return {};
+        }
+
+        if (!dir.empty())
+            bases.emplace_back(dir);
+
+        bases.insert(bases.end(), m_includePaths.begin(), m_includePaths.end());
+
+        for (auto &base : bases) {
+            for (auto &candidate : {base + name, base + name + ".glsl", base + "shaders/" + name + ".glsl"}) {
+                if (fileExists(candidate)) {
+                    return candidate;
+                }
+            }
+        }
+
+        return {};
+    }
+
+    bool expand(const string &path, string &out) {
+        if (!m_included.insert(path).second)
+            return true; // already included
+
+        string content;
+
+        if (!readFile(path, content)) {
+            cerr << "ShaderSource: can't read " << path << "\n";
+            return false;
+        }
+
+        istringstream stream(content);
+        string line;
+
+        while (getline(stream, line)) {
+            auto directive = line.find("#alp include");
+
+            if (directive == string::npos) {
+                out += line;
+                out += '\n';
+                continue;
+            }
+
+            auto begin = line.find_first_of("<\"", directive);
+            auto end = begin == string::npos ? string::npos : line.find_first_of(">\"", begin + 1);
+
+            if (end == string::npos) {
+                cerr << "ShaderSource: invalid include in " << path << ": " << line << "\n";
+                return false;
+            }
+
+            auto name = line.substr(begin + 1, end - begin - 1);
+            auto dir = line[begin] == '"' ? getDirectory(path) : string();
+            auto includePath = resolve(name, dir);
+
+            if (includePath.empty()) {
+                cerr << "ShaderSource: can't resolve include " << name << " in " << path << "\n";
+                return false;
+            }
+
+            if (!expand(includePath, out)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void reset() {
+        m_included.clear();
+    }
+
+private:
+    const vector<string> &m_includePaths;
+    set<string> m_included;
+};
+
+uint getShaderType(const string &type) {
+    if (type == "vertex")
+        return GL_VERTEX_SHADER;
+
+    if (type == "fragment")
+        return GL_FRAGMENT_SHADER;
+
+    if (type == "geometry")
+        return GL_GEOMETRY_SHADER;
+
+    if (type == "compute")
+        return GL_COMPUTE_SHADER;
+
+    return 0;
+}
+
+string getDefines(const json &config) {
+    string defines;
+
+    if (config.contains("definitions"))
+        for (auto &[name, value] : config["definitions"].items())
+            defines += "#define " + name + " " + value.get<string>() + "\n";
+
+    if (config.contains("params"))
+        for (auto &param : config["params"])
+            defines += "#define " + param.get<string>() + "\n";
+
+    return defines;
+}
+
+/**
+ * Inserts the defines after the <code>#version</code> line, if any
+ */
+string injectDefines(const string &source, const string &defines) {
+    if (defines.empty())
+        return source;
+
+    auto version = source.find("#version");
+
+    if (version == string::npos)
+        return defines + source;
+
+    auto lineEnd = source.find('\n', version);
+
+    if (lineEnd == string::npos)
+        return source + "\n" + defines;
+
+    return source.substr(0, lineEnd + 1) + defines + source.substr(lineEnd + 1);
+}
+}
+
+uint64_t ProgramSource::hash(uint64_t seed) const {
+    auto hash = seed;
+
+    for (auto &shader : shaders) {
+        hash = fnv1a(hash, &shader.type, sizeof(shader.type));
+        hash = fnv1a(hash, shader.source.c_str(), shader.source.size() + 1);
+    }
+
+    for (auto &varying : feedbackVaryings)
+        hash = fnv1a(hash, varying.c_str(), varying.size() + 1);
+
+    return hash;
+}
+
+bool loadProgramSource(const string &configPath, const vector<string> &includePaths, ProgramSource &program) {
+    string content;
+
+    if (!readFile(configPath, content)) {
+        cerr << "ShaderSource: can't read " << configPath << "\n";
+        return false;
+    }
+
+    json config = json::parse(content, nullptr, false);
+
+    if (config.is_discarded() || !config.contains("shaders")) {
+        cerr << "ShaderSource: invalid program config " << configPath << "\n";
+        return false;
+    }
+
+    program.name = config.value("access", "private") == "public" ? config.value("name", "") : "";
+    program.shaders.clear();
+
+    auto programDefines = getDefines(config);
+    auto configDir = getDirectory(configPath);
+
+    Expander expander(includePaths);
+
+    for (auto &entry : config["shaders"]) {
+        json shaderConfig;
+        string shaderDir;
+
+        if (entry.contains("dump")) {
+            shaderConfig = entry["dump"];
+            shaderDir = configDir;
+        } else {
+            auto shaderConfigPath = expander.resolve(entry.value("path", ""), configDir);
+            string shaderContent;
+
+            if (shaderConfigPath.empty() || !readFile(shaderConfigPath, shaderContent)) {
+                cerr << "ShaderSource: can't read shader config of " << configPath << "\n";
+                return false;
+            }
+
+            shaderConfig = json::parse(shaderContent, nullptr, false);
+            shaderDir = getDirectory(shaderConfigPath);
+
+            if (shaderConfig.is_discarded()) {
+                cerr << "ShaderSource: invalid shader config " << shaderConfigPath << "\n";
+                return false;
+            }
+        }
+
+        auto type = getShaderType(shaderConfig.value("type", ""));
+        auto path = expander.resolve(shaderConfig.value("path", ""), shaderDir);
+
+        if (type == 0 || path.empty()) {
+            cerr << "ShaderSource: invalid shader in " << configPath << "\n";
+            return false;
+        }
+
+        string source;
+
+        expander.reset();
+
+        if (!expander.expand(path, source))
+            return false;
+
+        program.shaders.push_back({type, injectDefines(source, programDefines + getDefines(shaderConfig))});
+    }
+
+    return true;
+}
+
+void registerPublicProgram(const ShaderProgramPtr &program, const ProgramSource &source) {
+    if (source.name.empty())
+        return;
+
+    program->setName(source.name);
+    ShaderProgram::publicObjects.emplace_back(program);
+}
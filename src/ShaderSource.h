@@ -0,0 +1,49 @@
+#ifndef ALGINE_EXAMPLES_SHADERSOURCE_H
+#define ALGINE_EXAMPLES_SHADERSOURCE_H
+
+#include <algine/core/shader/ShaderProgramPtr.h>
+#include <algine/types.h>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+using namespace algine;
+
+/**
+ * Fully expanded sources of the program described by the <code>*.conf.json</code> config:
+ * <code>#alp include</code> directives are resolved, definitions and params
+ * of the program and its shaders are injected right after <code>#version</code>.
+ * Doesn't need the GL context, so it can be loaded on the worker threads
+ */
+struct ProgramSource {
+    struct Shader {
+        uint type; // GL_VERTEX_SHADER, GL_FRAGMENT_SHADER or GL_GEOMETRY_SHADER
+        std::string source;
+    };
+
+    std::string name; // empty for the private programs
+    std::vector<Shader> shaders;
+    std::vector<std::string> feedbackVaryings; // captured by transform feedback, interleaved
+
+    /**
+     * @return hash of the expanded sources, their types and feedback varyings
+     */
+    uint64_t hash(uint64_t seed = 14695981039346656037ull) const;
+};
+
+/**
+ * @param includePaths the same paths as passed to <code>ShaderCreator::setGlobalIncludePaths</code>
+ * @return false if the config or any of the sources can't be read
+ */
+bool loadProgramSource(const std::string &configPath, const std::vector<std::string> &includePaths,
+                       ProgramSource &program);
+
+/**
+ * Registers the program by the name of its public config, so it
+ * can be referenced by the input layout locations. Programs created
+ * by <code>ShaderProgramCreator</code> are registered by the engine itself
+ */
+void registerPublicProgram(const ShaderProgramPtr &program, const ProgramSource &source);
+
+#endif //ALGINE_EXAMPLES_SHADERSOURCE_H
@@ -0,0 +1,29 @@
+#include "ShadowCache.h"
+
+void ShadowCache::begin(const glm::mat4 &light) {
+    m_currentLight = light;
+    m_currentCasters.clear();
+}
+
+void ShadowCache::addCaster(const void *caster, const glm::mat4 &transformation, uint64_t bonesVersion) {
+    m_currentCasters.push_back({caster, transformation, bonesVersion});
+}
+
+bool ShadowCache::end() {
+    if (m_valid && m_light == m_currentLight && m_casters == m_currentCasters)
+        return false;
+
+    m_light = m_currentLight;
+    m_casters.swap(m_currentCasters);
+    m_valid = true;
+
+    return true;
+}
+
+void ShadowCache::invalidate() {
+    m_valid = false;
+}
+
+bool ShadowCache::Caster::operator==(const Caster &other) const {
+    return caster == other.caster && transformation == other.transformation && bonesVersion == other.bonesVersion;
+}
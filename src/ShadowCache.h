@@ -0,0 +1,57 @@
+#ifndef ALGINE_EXAMPLES_SHADOWCACHE_H
+#define ALGINE_EXAMPLES_SHADOWCACHE_H
+
+#include <algine/types.h>
+
+#include <glm/mat4x4.hpp>
+
+#include <vector>
+#include <cstdint>
+
+using namespace algine;
+
+struct ShadowCacheStats {
+    uint rendered = 0;
+    uint skipped = 0;
+};
+
+/**
+ * Decides whether the shadow map must be re-rendered. Signature of the
+ * shadow map consists of the light matrix and casters inside the light volume
+ * (their transformations and bones versions); if the signature is the same
+ * as during the last rendering, the shadow map is still valid.
+ */
+class ShadowCache {
+public:
+    void begin(const glm::mat4 &light);
+
+    /**
+     * @param bonesVersion 0 for static casters, otherwise must be changed
+     * every time when the bones of the caster are changed
+     */
+    void addCaster(const void *caster, const glm::mat4 &transformation, uint64_t bonesVersion = 0);
+
+    /**
+     * @return true if the shadow map must be re-rendered
+     */
+    bool end();
+
+    void invalidate();
+
+private:
+    struct Caster {
+        const void *caster;
+        glm::mat4 transformation;
+        uint64_t bonesVersion;
+
+        bool operator==(const Caster &other) const;
+    };
+
+    bool m_valid = false;
+    glm::mat4 m_light {1.0f};
+    glm::mat4 m_currentLight {1.0f};
+    std::vector<Caster> m_casters;
+    std::vector<Caster> m_currentCasters;
+};
+
+#endif //ALGINE_EXAMPLES_SHADOWCACHE_H
@@ -0,0 +1,162 @@
+#ifndef ALGINE_EXAMPLES_SIMD_H
+#define ALGINE_EXAMPLES_SIMD_H
+
+/**
+ * Minimal 4-wide float vector over SSE, NEON or plain scalars,
+ * enough for the structure-of-arrays animation kernels
+ */
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define ALGINE_EXAMPLES_SIMD_SSE
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define ALGINE_EXAMPLES_SIMD_NEON
+    #include <arm_neon.h>
+#else
+    #include <cmath>
+#endif
+
+struct float4 {
+#if defined(ALGINE_EXAMPLES_SIMD_SSE)
+    __m128 v;
+#elif defined(ALGINE_EXAMPLES_SIMD_NEON)
+    float32x4_t v;
+#else
+    float v[4];
+#endif
+};
+
+constexpr const char* simdName() {
+#if defined(ALGINE_EXAMPLES_SIMD_SSE)
+    return "sse";
+#elif defined(ALGINE_EXAMPLES_SIMD_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+#if defined(ALGINE_EXAMPLES_SIMD_SSE)
+
+inline float4 load4(const float *p) { return {_mm_loadu_ps(p)}; }
+inline void store4(float *p, float4 a) { _mm_storeu_ps(p, a.v); }
+inline float4 splat4(float a) { return {_mm_set1_ps(a)}; }
+inline float4 operator+(float4 a, float4 b) { return {_mm_add_ps(a.v, b.v)}; }
+inline float4 operator-(float4 a, float4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+inline float4 operator*(float4 a, float4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+
+inline float4 abs4(float4 a) {
+    return {_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)};
+}
+
+/**
+ * @return b with the sign of a flipped if a is negative
+ */
+inline float4 mulSign4(float4 b, float4 a) {
+    return {_mm_xor_ps(b.v, _mm_and_ps(a.v, _mm_set1_ps(-0.0f)))};
+}
+
+inline float4 rsqrt4(float4 a) {
+    // estimate + one Newton-Raphson step
+    __m128 y = _mm_rsqrt_ps(a.v);
+    __m128 yy = _mm_mul_ps(y, y);
+    __m128 half = _mm_mul_ps(_mm_set1_ps(0.5f), y);
+    return {_mm_mul_ps(half, _mm_sub_ps(_mm_set1_ps(3.0f), _mm_mul_ps(a.v, yy)))};
+}
+
+inline void transpose4(float4 &a, float4 &b, float4 &c, float4 &d) {
+    _MM_TRANSPOSE4_PS(a.v, b.v, c.v, d.v);
+}
+
+#elif defined(ALGINE_EXAMPLES_SIMD_NEON)
+
+inline float4 load4(const float *p) { return {vld1q_f32(p)}; }
+inline void store4(float *p, float4 a) { vst1q_f32(p, a.v); }
+inline float4 splat4(float a) { return {vdupq_n_f32(a)}; }
+inline float4 operator+(float4 a, float4 b) { return {vaddq_f32(a.v, b.v)}; }
+inline float4 operator-(float4 a, float4 b) { return {vsubq_f32(a.v, b.v)}; }
+inline float4 operator*(float4 a, float4 b) { return {vmulq_f32(a.v, b.v)}; }
+
+inline float4 abs4(float4 a) {
+    return {vabsq_f32(a.v)};
+}
+
+inline float4 mulSign4(float4 b, float4 a) {
+    uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(a.v), vdupq_n_u32(0x80000000u));
+    return {vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(b.v), sign))};
+}
+
+inline float4 rsqrt4(float4 a) {
+    float32x4_t y = vrsqrteq_f32(a.v);
+    y = vmulq_f32(y, vrsqrtsq_f32(vmulq_f32(a.v, y), y));
+    return {y};
+}
+
+inline void transpose4(float4 &a, float4 &b, float4 &c, float4 &d) {
+    float32x4x2_t ab = vtrnq_f32(a.v, b.v);
+    float32x4x2_t cd = vtrnq_f32(c.v, d.v);
+    a.v = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+    b.v = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+    c.v = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+    d.v = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+}
+
+#else
+
+inline float4 load4(const float *p) { return {{p[0], p[1], p[2], p[3]}}; }
+inline void store4(float *p, float4 a) { for (int i = 0; i < 4; i++) p[i] = a.v[i]; }
+inline float4 splat4(float a) { return {{a, a, a, a}}; }
+
+#define ALGINE_EXAMPLES_SIMD_OP(op) \
+    inline float4 operator op(float4 a, float4 b) { \
+        return {{a.v[0] op b.v[0], a.v[1] op b.v[1], a.v[2] op b.v[2], a.v[3] op b.v[3]}}; \
+    }
+
+ALGINE_EXAMPLES_SIMD_OP(+)
+ALGINE_EXAMPLES_SIMD_OP(-)
+ALGINE_EXAMPLES_SIMD_OP(*)
+
+#undef ALGINE_EXAMPLES_SIMD_OP
+
+inline float4 abs4(float4 a) {
+    return {{std::fabs(a.v[0]), std::fabs(a.v[1]), std::fabs(a.v[2]), std::fabs(a.v[3])}};
+}
+
+inline float4 mulSign4(float4 b, float4 a) {
+    float4 r;
+
+    for (int i = 0; i < 4; i++)
+        r.v[i] = std::signbit(a.v[i]) ? -b.v[i] : b.v[i];
+
+    return r;
+}
+
+inline float4 rsqrt4(float4 a) {
+    float4 r;
+
+    for (int i = 0; i < 4; i++)
+        r.v[i] = 1.0f / std::sqrt(a.v[i]);
+
+    return r;
+}
+
+inline void transpose4(float4 &a, float4 &b, float4 &c, float4 &d) {
+    float m[4][4];
+    store4(m[0], a); store4(m[1], b); store4(m[2], c); store4(m[3], d);
+
+    a = {{m[0][0], m[1][0], m[2][0], m[3][0]}};
+    b = {{m[0][1], m[1][1], m[2][1], m[3][1]}};
+    c = {{m[0][2], m[1][2], m[2][2], m[3][2]}};
+    d = {{m[0][3], m[1][3], m[2][3], m[3][3]}};
+}
+
+#endif
+
+/**
+ * @return a * b + c
+ */
+inline float4 madd4(float4 a, float4 b, float4 c) {
+    return a * b + c;
+}
+
+#endif //ALGINE_EXAMPLES_SIMD_H
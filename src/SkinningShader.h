@@ -0,0 +1,18 @@
+#ifndef SKINNINGSHADER_H
+#define SKINNINGSHADER_H
+
+#define constant(name, val) constexpr char name[] = val;
+
+namespace SkinningShader::Vars {
+constant(SkinnedPos, "skinnedPos")
+constant(SkinnedNormal, "skinnedNormal")
+constant(SkinnedTangent, "skinnedTangent")
+constant(SkinnedBitangent, "skinnedBitangent")
+
+// set in the color and shadow programs: vertices are already skinned
+constant(PreSkinned, "preSkinned")
+}
+
+#undef constant
+
+#endif //SKINNINGSHADER_H
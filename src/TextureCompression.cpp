@@ -0,0 +1,210 @@
+#include "TextureCompression.h"
+
+#include <algorithm>
+#include <climits>
+
+using namespace std;
+
+namespace {
+/**
+ * 4x4 block, pixels outside the image are clamped to the edge
+ */
+struct Block {
+    uint8_t pixels[16][4];
+
+    Block(const ImageRGBA &image, uint bx, uint by) {
+        for (uint y = 0; y < 4; y++) {
+            for (uint x = 0; x < 4; x++) {
+                auto px = min(bx * 4 + x, image.width - 1);
+                auto py = min(by * 4 + y, image.height - 1);
+                auto src = &image.pixels[(py * image.width + px) * 4];
+
+                copy(src, src + 4, pixels[y * 4 + x]);
+            }
+        }
+    }
+};
+
+uint16_t toRGB565(const uint8_t *color) {
+    return static_cast<uint16_t>(((color[0] >> 3) << 11) | ((color[1] >> 2) << 5) | (color[2] >> 3));
+}
+
+void fromRGB565(uint16_t color, int *result) {
+    int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+
+    result[0] = (r << 3) | (r >> 2);
+    result[1] = (g << 2) | (g >> 4);
+    result[2] = (b << 3) | (b >> 2);
+}
+
+void writeUint16(uint8_t *dst, uint16_t value) {
+    dst[0] = static_cast<uint8_t>(value & 0xff);
+    dst[1] = static_cast<uint8_t>(value >> 8);
+}
+
+/**
+ * Endpoints are the corners of the colors bounding box, inset by 1/16
+ * to reduce the error of the interpolated colors
+ */
+void encodeColorBlock(const Block &block, uint8_t *dst) {
+    uint8_t minColor[3] {255, 255, 255};
+    uint8_t maxColor[3] {0, 0, 0};
+
+    for (auto &pixel : block.pixels) {
+        for (int c = 0; c < 3; c++) {
+            minColor[c] = min(minColor[c], pixel[c]);
+            maxColor[c] = max(maxColor[c], pixel[c]);
+        }
+    }
+
+    for (int c = 0; c < 3; c++) {
+        int inset = (maxColor[c] - minColor[c]) / 16;
+        minColor[c] = static_cast<uint8_t>(min(minColor[c] + inset, 255));
+        maxColor[c] = static_cast<uint8_t>(max(maxColor[c] - inset, 0));
+    }
+
+    auto color0 = toRGB565(maxColor);
+    auto color1 = toRGB565(minColor);
+
+    // color0 > color1 selects the 4 colors mode
+    if (color0 < color1)
+        swap(color0, color1);
+
+    writeUint16(dst, color0);
+    writeUint16(dst + 2, color1);
+
+    uint32_t indices = 0;
+
+    if (color0 != color1) {
+        int palette[4][3];
+        fromRGB565(color0, palette[0]);
+        fromRGB565(color1, palette[1]);
+
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for (uint i = 0; i < 16; i++) {
+            int best = 0, bestDistance = INT_MAX;
+
+            for (int p = 0; p < 4; p++) {
+                int distance = 0;
+
+                for (int c = 0; c < 3; c++) {
+                    int d = block.pixels[i][c] - palette[p][c];
+                    distance += d * d;
+                }
+
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+
+            indices |= static_cast<uint32_t>(best) << (i * 2);
+        }
+    }
+
+    for (int i = 0; i < 4; i++) {
+        dst[4 + i] = static_cast<uint8_t>(indices >> (i * 8));
+    }
+}
+
+void encodeAlphaBlock(const Block &block, uint8_t *dst) {
+    uint8_t minAlpha = 255, maxAlpha = 0;
+
+    for (auto &pixel : block.pixels) {
+        minAlpha = min(minAlpha, pixel[3]);
+        maxAlpha = max(maxAlpha, pixel[3]);
+    }
+
+    // alpha0 > alpha1 selects the 8 values mode
+    dst[0] = maxAlpha;
+    dst[1] = minAlpha;
+
+    int palette[8];
+    palette[0] = maxAlpha;
+    palette[1] = minAlpha;
+
+    for (int i = 1; i < 7; i++)
+        palette[i + 1] = ((7 - i) * maxAlpha + i * minAlpha) / 7;
+
+    uint64_t indices = 0;
+
+    if (maxAlpha != minAlpha) {
+        for (uint i = 0; i < 16; i++) {
+            int best = 0, bestDistance = INT_MAX;
+
+            for (int p = 0; p < 8; p++) {
+                int distance = abs(block.pixels[i][3] - palette[p]);
+
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+
+            indices |= static_cast<uint64_t>(best) << (i * 3);
+        }
+    }
+
+    for (int i = 0; i < 6; i++) {
+        dst[2 + i] = static_cast<uint8_t>(indices >> (i * 8));
+    }
+}
+
+template<typename F>
+vector<uint8_t> encode(const ImageRGBA &image, uint blockSize, F encodeBlock) {
+    uint blocksX = (image.width + 3) / 4;
+    uint blocksY = (image.height + 3) / 4;
+
+    vector<uint8_t> result(blocksX * blocksY * blockSize);
+
+    for (uint by = 0; by < blocksY; by++) {
+        for (uint bx = 0; bx < blocksX; bx++) {
+            encodeBlock(Block(image, bx, by), &result[(by * blocksX + bx) * blockSize]);
+        }
+    }
+
+    return result;
+}
+}
+
+ImageRGBA downsample(const ImageRGBA &image) {
+    ImageRGBA result;
+    result.width = max(image.width / 2, 1u);
+    result.height = max(image.height / 2, 1u);
+    result.pixels.resize(result.width * result.height * 4);
+
+    for (uint y = 0; y < result.height; y++) {
+        for (uint x = 0; x < result.width; x++) {
+            uint x0 = min(x * 2, image.width - 1), x1 = min(x * 2 + 1, image.width - 1);
+            uint y0 = min(y * 2, image.height - 1), y1 = min(y * 2 + 1, image.height - 1);
+
+            for (uint c = 0; c < 4; c++) {
+                auto at = [&](uint px, uint py) {
+                    return image.pixels[(py * image.width + px) * 4 + c];
+                };
+
+                result.pixels[(y * result.width + x) * 4 + c] =
+                        static_cast<uint8_t>((at(x0, y0) + at(x1, y0) + at(x0, y1) + at(x1, y1) + 2) / 4);
+            }
+        }
+    }
+
+    return result;
+}
+
+vector<uint8_t> encodeBC1(const ImageRGBA &image) {
+    return encode(image, 8, [](const Block &block, uint8_t *dst) {
+        encodeColorBlock(block, dst);
+    });
+}
+
+vector<uint8_t> encodeBC3(const ImageRGBA &image) {
+    return encode(image, 16, [](const Block &block, uint8_t *dst) {
+        encodeAlphaBlock(block, dst);
+        encodeColorBlock(block, dst + 8);
+    });
+}
@@ -0,0 +1,35 @@
+#ifndef ALGINE_EXAMPLES_TEXTURECOMPRESSION_H
+#define ALGINE_EXAMPLES_TEXTURECOMPRESSION_H
+
+#include <algine/types.h>
+
+#include <vector>
+#include <cstdint>
+
+using namespace algine;
+
+/**
+ * 8-bit RGBA image
+ */
+struct ImageRGBA {
+    uint width = 0;
+    uint height = 0;
+    std::vector<uint8_t> pixels;
+};
+
+/**
+ * @return the next mip level, 2x2 box filter
+ */
+ImageRGBA downsample(const ImageRGBA &image);
+
+/**
+ * BC1 (DXT1), RGB, 8 bytes per 4x4 block. Alpha is ignored
+ */
+std::vector<uint8_t> encodeBC1(const ImageRGBA &image);
+
+/**
+ * BC3 (DXT5), RGBA, 16 bytes per 4x4 block
+ */
+std::vector<uint8_t> encodeBC3(const ImageRGBA &image);
+
+#endif //ALGINE_EXAMPLES_TEXTURECOMPRESSION_H
@@ -0,0 +1,66 @@
+#ifndef ALGINE_EXAMPLES_TRIPLEBUFFER_H
+#define ALGINE_EXAMPLES_TRIPLEBUFFER_H
+
+#include <atomic>
+
+/**
+ * Lock-free single producer / single consumer triple buffer.
+ * Producer fills <code>back()</code> and calls <code>publish()</code>,
+ * consumer calls <code>read()</code> and always gets the latest complete
+ * value without blocking the producer.
+ */
+template<typename T>
+class TripleBuffer {
+public:
+    TripleBuffer()
+        : m_front(0),
+          m_middle(1),
+          m_back(2) {}
+
+    /**
+     * Not thread safe, must be called when neither producer nor consumer are active
+     */
+    void reset(const T &value) {
+        for (auto &buffer : m_buffers) {
+            buffer = value;
+        }
+
+        m_middle = m_middle & IndexMask;
+    }
+
+    /**
+     * Producer side
+     */
+    T& back() {
+        return m_buffers[m_back];
+    }
+
+    /**
+     * Producer side
+     */
+    void publish() {
+        m_back = m_middle.exchange(m_back | DirtyBit, std::memory_order_acq_rel) & IndexMask;
+    }
+
+    /**
+     * Consumer side
+     */
+    const T& read() {
+        if (m_middle.load(std::memory_order_acquire) & DirtyBit) {
+            m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & IndexMask;
+        }
+
+        return m_buffers[m_front];
+    }
+
+private:
+    constexpr static unsigned DirtyBit = 0b100;
+    constexpr static unsigned IndexMask = 0b011;
+
+    T m_buffers[3];
+    unsigned m_front;
+    std::atomic<unsigned> m_middle;
+    unsigned m_back;
+};
+
+#endif //ALGINE_EXAMPLES_TRIPLEBUFFER_H
@@ -0,0 +1,273 @@
+#include "UniformBlockStaging.h"
+#include "GLExtensions.h"
+
+#include <algine/core/shader/ShaderProgram.h>
+#include <algine/gl.h>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+
+using namespace std;
+
+constexpr static usize NotDirty = static_cast<usize>(-1);
+
+static bool isBufferStorageSupported() {
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+    return major > 4 || (major == 4 && minor >= 4) || isExtensionSupported("GL_ARB_buffer_storage");
+}
+
+UniformBlockStaging::UniformBlockStaging()
+    : m_bindingPoint(0),
+      m_buffer(0),
+      m_dirtyBegin(NotDirty),
+      m_dirtyEnd(0),
+      m_uploadedBytes(0),
+      m_ring(0),
+      m_ringPtr(nullptr),
+      m_ringStride(0),
+      m_ringIndex(0),
+      m_ringFences() {}
+
+UniformBlockStaging::~UniformBlockStaging() {
+    for (auto fence : m_ringFences) {
+        if (fence) {
+            glDeleteSync(static_cast<GLsync>(fence));
+        }
+    }
+
+    if (m_ring != 0) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_ring);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glDeleteBuffers(1, &m_ring);
+    }
+}
+
+void UniformBlockStaging::init(const ShaderProgramPtr &program, uint bindingPoint, bool persistent) {
+    auto id = program->getId();
+
+    m_bindingPoint = bindingPoint;
+
+    // find the block by its binding point
+    GLint blocksCount = 0;
+    glGetProgramiv(id, GL_ACTIVE_UNIFORM_BLOCKS, &blocksCount);
+
+    GLint blockIndex = -1;
+
+    for (GLint i = 0; i < blocksCount; i++) {
+        GLint binding;
+        glGetActiveUniformBlockiv(id, i, GL_UNIFORM_BLOCK_BINDING, &binding);
+
+        if (binding == static_cast<GLint>(bindingPoint)) {
+            blockIndex = i;
+            break;
+        }
+    }
+
+    if (blockIndex == -1) {
+        cerr << "UniformBlockStaging: block with binding point " << bindingPoint << " not found\n";
+        return;
+    }
+
+    GLint dataSize, uniformsCount, nameLength;
+    glGetActiveUniformBlockiv(id, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize);
+    glGetActiveUniformBlockiv(id, blockIndex, GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS, &uniformsCount);
+    glGetActiveUniformBlockiv(id, blockIndex, GL_UNIFORM_BLOCK_NAME_LENGTH, &nameLength);
+
+    string blockName(nameLength, '\0');
+    glGetActiveUniformBlockName(id, blockIndex, nameLength, nullptr, &blockName[0]);
+    blockName.resize(strlen(blockName.c_str()));
+
+    vector<GLint> indices(uniformsCount);
+    glGetActiveUniformBlockiv(id, blockIndex, GL_UNIFORM_BLOCK_ACTIVE_UNIFORM_INDICES, indices.data());
+
+    vector<GLuint> uindices(indices.begin(), indices.end());
+    vector<GLint> offsets(uniformsCount), matrixStrides(uniformsCount);
+    glGetActiveUniformsiv(id, uniformsCount, uindices.data(), GL_UNIFORM_OFFSET, offsets.data());
+    glGetActiveUniformsiv(id, uniformsCount, uindices.data(), GL_UNIFORM_MATRIX_STRIDE, matrixStrides.data());
+
+    GLint maxNameLength;
+    glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    string name(maxNameLength, '\0');
+
+    for (GLint i = 0; i < uniformsCount; i++) {
+        GLsizei length;
+        glGetActiveUniformName(id, uindices[i], maxNameLength, &length, &name[0]);
+
+        string uniformName = name.substr(0, length);
+
+        // variables of the named block instance are prefixed by the block name
+        if (uniformName.compare(0, blockName.size() + 1, blockName + ".") == 0)
+            uniformName.erase(0, blockName.size() + 1);
+
+        m_locations[uniformName] = static_cast<Location>(m_variables.size());
+        m_variables.push_back({static_cast<uint>(offsets[i]), static_cast<uint>(matrixStrides[i])});
+    }
+
+    // read the current content, so values written before
+    // (e.g. by LightingManager) are not lost
+    GLint buffer = 0;
+    glGetIntegeri_v(GL_UNIFORM_BUFFER_BINDING, bindingPoint, &buffer);
+    m_buffer = static_cast<uint>(buffer);
+
+    m_data.resize(dataSize);
+
+    glBindBuffer(GL_COPY_READ_BUFFER, m_buffer);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, 0, dataSize, m_data.data());
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+    // persistent ring, replaces the original buffer at the binding point
+    if (persistent && isBufferStorageSupported()) {
+        GLint alignment;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+
+        m_ringStride = (m_data.size() + alignment - 1) / alignment * alignment;
+
+        constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        glGenBuffers(1, &m_ring);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_ring);
+        glBufferStorage(GL_COPY_WRITE_BUFFER, m_ringStride * RingSize, nullptr, flags);
+        m_ringPtr = static_cast<uint8_t*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, m_ringStride * RingSize, flags));
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        memcpy(m_ringPtr, m_data.data(), m_data.size());
+        glBindBufferRange(GL_UNIFORM_BUFFER, m_bindingPoint, m_ring, 0, m_data.size());
+    }
+}
+
+UniformBlockStaging::Location UniformBlockStaging::getLocation(const string &name) const {
+    if (auto it = m_locations.find(name); it != m_locations.end())
+        return it->second;
+
+    cerr << "UniformBlockStaging: variable " << name << " not found\n";
+
+    return NoLocation;
+}
+
+void UniformBlockStaging::setInt(Location location, int value) {
+    write(location, &value, sizeof(value));
+}
+
+void UniformBlockStaging::setUint(Location location, uint value) {
+    write(location, &value, sizeof(value));
+}
+
+void UniformBlockStaging::setFloat(Location location, float value) {
+    write(location, &value, sizeof(value));
+}
+
+void UniformBlockStaging::setVec3(Location location, const glm::vec3 &value) {
+    write(location, glm::value_ptr(value), sizeof(value));
+}
+
+void UniformBlockStaging::setMat4(Location location, const glm::mat4 &value) {
+    if (location == NoLocation)
+        return;
+
+    auto &variable = m_variables[location];
+
+    if (variable.matrixStride == sizeof(glm::vec4)) {
+        write(location, glm::value_ptr(value), sizeof(value));
+        return;
+    }
+
+    // non-tightly packed columns
+    for (int i = 0; i < 4; i++) {
+        auto offset = variable.offset + i * variable.matrixStride;
+
+        if (memcmp(&m_data[offset], glm::value_ptr(value[i]), sizeof(glm::vec4)) != 0) {
+            memcpy(&m_data[offset], glm::value_ptr(value[i]), sizeof(glm::vec4));
+            markDirty(offset, offset + sizeof(glm::vec4));
+        }
+    }
+}
+
+void UniformBlockStaging::setInt(const string &name, int value) {
+    setInt(getLocation(name), value);
+}
+
+void UniformBlockStaging::setUint(const string &name, uint value) {
+    setUint(getLocation(name), value);
+}
+
+void UniformBlockStaging::setFloat(const string &name, float value) {
+    setFloat(getLocation(name), value);
+}
+
+void UniformBlockStaging::setVec3(const string &name, const glm::vec3 &value) {
+    setVec3(getLocation(name), value);
+}
+
+void UniformBlockStaging::setMat4(const string &name, const glm::mat4 &value) {
+    setMat4(getLocation(name), value);
+}
+
+void UniformBlockStaging::flush() {
+    m_uploadedBytes = 0;
+
+    if (m_dirtyBegin == NotDirty)
+        return;
+
+    if (m_ringPtr) {
+        // fence the segment used by the already submitted commands
+        // and move to the next one, waiting if GPU still reads it
+        m_ringFences[m_ringIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_ringIndex = (m_ringIndex + 1) % RingSize;
+
+        if (auto fence = static_cast<GLsync>(m_ringFences[m_ringIndex]); fence) {
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            glDeleteSync(fence);
+            m_ringFences[m_ringIndex] = nullptr;
+        }
+
+        auto offset = m_ringIndex * m_ringStride;
+
+        memcpy(m_ringPtr + offset, m_data.data(), m_data.size());
+        glBindBufferRange(GL_UNIFORM_BUFFER, m_bindingPoint, m_ring, offset, m_data.size());
+
+        m_uploadedBytes = m_data.size();
+    } else {
+        m_uploadedBytes = m_dirtyEnd - m_dirtyBegin;
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, m_dirtyBegin, m_uploadedBytes, &m_data[m_dirtyBegin]);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    m_dirtyBegin = NotDirty;
+    m_dirtyEnd = 0;
+}
+
+bool UniformBlockStaging::isPersistent() const {
+    return m_ringPtr != nullptr;
+}
+
+usize UniformBlockStaging::getUploadedBytes() const {
+    return m_uploadedBytes;
+}
+
+void UniformBlockStaging::write(Location location, const void *data, uint size) {
+    if (location == NoLocation)
+        return;
+
+    auto offset = m_variables[location].offset;
+
+    // unchanged values are not marked dirty
+    if (memcmp(&m_data[offset], data, size) == 0)
+        return;
+
+    memcpy(&m_data[offset], data, size);
+    markDirty(offset, offset + size);
+}
+
+void UniformBlockStaging::markDirty(usize begin, usize end) {
+    m_dirtyBegin = min(m_dirtyBegin, begin);
+    m_dirtyEnd = max(m_dirtyEnd, end);
+}
@@ -0,0 +1,103 @@
+#ifndef ALGINE_EXAMPLES_UNIFORMBLOCKSTAGING_H
+#define ALGINE_EXAMPLES_UNIFORMBLOCKSTAGING_H
+
+#include <algine/core/shader/ShaderProgramPtr.h>
+#include <algine/types.h>
+
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+using namespace algine;
+
+/**
+ * CPU copy of the uniform block in the layout reported by the driver (std140).
+ * Values are written to the CPU copy, only the changed bytes are marked dirty,
+ * <code>flush()</code> uploads the whole change in one call.
+ * Variables can be set by their locations, resolved once by <code>getLocation</code>,
+ * to avoid the name lookups in the per-frame code.
+ * If GL 4.4 or ARB_buffer_storage is available, the block is uploaded to the persistently
+ * mapped triple-buffered ring, which is bound to the block's binding point instead
+ * of the original buffer. Otherwise, the dirty range is uploaded to the original
+ * buffer with single glBufferSubData.
+ * Note: in the persistent mode the original buffer is no longer bound and isn't
+ * read again, so after <code>init</code> the block must be written only through the staging
+ * (e.g. not by <code>LightingManager</code> directly), otherwise the writes are lost.
+ */
+class UniformBlockStaging {
+public:
+    using Location = int;
+
+    constexpr static Location NoLocation = -1;
+
+public:
+    UniformBlockStaging();
+    ~UniformBlockStaging();
+
+    /**
+     * Reads the layout of the block bound to <code>bindingPoint</code> and its current
+     * content from the buffer bound to this binding point, so all values written
+     * before remain valid
+     */
+    void init(const ShaderProgramPtr &program, uint bindingPoint, bool persistent = true);
+
+    /**
+     * @return <code>NoLocation</code> if the block doesn't have the variable,
+     * setters ignore it
+     */
+    Location getLocation(const std::string &name) const;
+
+    void setInt(Location location, int value);
+    void setUint(Location location, uint value);
+    void setFloat(Location location, float value);
+    void setVec3(Location location, const glm::vec3 &value);
+    void setMat4(Location location, const glm::mat4 &value);
+
+    void setInt(const std::string &name, int value);
+    void setUint(const std::string &name, uint value);
+    void setFloat(const std::string &name, float value);
+    void setVec3(const std::string &name, const glm::vec3 &value);
+    void setMat4(const std::string &name, const glm::mat4 &value);
+
+    void flush();
+
+    bool isPersistent() const;
+
+    /**
+     * Statistics of the last flush
+     */
+    usize getUploadedBytes() const;
+
+private:
+    struct Variable {
+        uint offset;
+        uint matrixStride;
+    };
+
+    void write(Location location, const void *data, uint size);
+    void markDirty(usize begin, usize end);
+
+private:
+    constexpr static uint RingSize = 3;
+
+    uint m_bindingPoint;
+    uint m_buffer; // original buffer
+    std::vector<uint8_t> m_data;
+    std::vector<Variable> m_variables; // by location
+    std::unordered_map<std::string, Location> m_locations;
+    usize m_dirtyBegin, m_dirtyEnd;
+    usize m_uploadedBytes;
+
+    // persistent ring
+    uint m_ring;
+    uint8_t *m_ringPtr;
+    usize m_ringStride;
+    uint m_ringIndex;
+    void *m_ringFences[RingSize];
+};
+
+#endif //ALGINE_EXAMPLES_UNIFORMBLOCKSTAGING_H
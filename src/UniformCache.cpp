@@ -0,0 +1,73 @@
+#include "UniformCache.h"
+
+#include <algine/core/shader/ShaderProgram.h>
+#include <algine/gl.h>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <string>
+#include <mutex>
+
+using namespace std;
+
+UniformCache::UniformCache(const ShaderProgramPtr &program) {
+    setProgram(program);
+}
+
+void UniformCache::setProgram(const ShaderProgramPtr &program) {
+    m_program = program;
+    m_entries.clear();
+}
+
+const ShaderProgramPtr& UniformCache::getProgram() const {
+    return m_program;
+}
+
+uint UniformCache::registerName(const char *name) {
+    static mutex namesMutex;
+    static vector<string> names;
+
+    lock_guard locker(namesMutex);
+
+    for (uint i = 0; i < names.size(); i++) {
+        if (names[i] == name) {
+            return i;
+        }
+    }
+
+    names.emplace_back(name);
+
+    return static_cast<uint>(names.size() - 1);
+}
+
+UniformCache::Entry& UniformCache::getEntry(uint slot, const char *name) {
+    if (slot >= m_entries.size())
+        m_entries.resize(slot + 1);
+
+    auto &entry = m_entries[slot];
+
+    if (entry.location == -2)
+        entry.location = glGetUniformLocation(m_program->getId(), name);
+
+    return entry;
+}
+
+void UniformCache::upload(int location, int value) {
+    glUniform1i(location, value);
+}
+
+void UniformCache::upload(int location, float value) {
+    glUniform1f(location, value);
+}
+
+void UniformCache::upload(int location, const glm::vec3 &value) {
+    glUniform3fv(location, 1, glm::value_ptr(value));
+}
+
+void UniformCache::upload(int location, const glm::mat3 &value) {
+    glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void UniformCache::upload(int location, const glm::mat4 &value) {
+    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+}
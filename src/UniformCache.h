@@ -0,0 +1,92 @@
+#ifndef ALGINE_EXAMPLES_UNIFORMCACHE_H
+#define ALGINE_EXAMPLES_UNIFORMCACHE_H
+
+#include <algine/core/shader/ShaderProgramPtr.h>
+#include <algine/types.h>
+
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include <vector>
+#include <cstring>
+
+using namespace algine;
+
+/**
+ * Locations and current values of the program uniforms.
+ * Uniforms are addressed by compile-time handles over the names from
+ * the shader vars tables, e.g. <code>uniforms.set<ColorShader::Vars::ModelMatrix>(matrix)</code>:
+ * each name gets its slot once, so the names are not hashed in the draw loops,
+ * and unchanged values are not sent again.
+ * Cached uniforms must be changed only through the cache; as for the
+ * <code>ShaderProgram</code> setters, the program must be bound
+ */
+class UniformCache {
+public:
+    UniformCache() = default;
+    explicit UniformCache(const ShaderProgramPtr &program);
+
+    /**
+     * Resets the locations and values
+     */
+    void setProgram(const ShaderProgramPtr &program);
+    const ShaderProgramPtr& getProgram() const;
+
+    /**
+     * @return true if the value has been sent, false if it is unchanged
+     * or the uniform is inactive
+     */
+    template<const char *Name, typename T>
+    bool set(const T &value) {
+        static_assert(sizeof(T) <= sizeof(Entry::value), "Unsupported uniform type");
+
+        auto &entry = getEntry(getSlot<Name>(), Name);
+
+        if (entry.location == -1)
+            return false;
+
+        if (entry.size == sizeof(T) && memcmp(entry.value, &value, sizeof(T)) == 0)
+            return false;
+
+        memcpy(entry.value, &value, sizeof(T));
+        entry.size = sizeof(T);
+
+        upload(entry.location, value);
+
+        return true;
+    }
+
+private:
+    struct Entry {
+        int location = -2; // -2 - not resolved yet, -1 - inactive
+        uint size = 0; // 0 - value is unknown
+        float value[16];
+    };
+
+    template<const char *Name>
+    static uint getSlot() {
+        static const uint slot = registerName(Name);
+        return slot;
+    }
+
+    /**
+     * Slots are assigned by the name contents, since the tables
+     * are defined in the headers and have own addresses in each translation unit
+     */
+    static uint registerName(const char *name);
+
+    Entry& getEntry(uint slot, const char *name);
+
+    static void upload(int location, int value);
+    static void upload(int location, float value);
+    static void upload(int location, const glm::vec3 &value);
+    static void upload(int location, const glm::mat3 &value);
+    static void upload(int location, const glm::mat4 &value);
+
+private:
+    ShaderProgramPtr m_program;
+    std::vector<Entry> m_entries;
+};
+
+#endif //ALGINE_EXAMPLES_UNIFORMCACHE_H
@@ -14,6 +14,8 @@ constexpr uint maxBones = 64;
 
 constexpr uint shadowMapResolution = 1024;
 
+constexpr uint simulationTickRate = 60;
+
 constexpr float bloomK = 0.5f;
 constexpr float dofK = 0.5f;
 constexpr uint bloomBlurKernelRadius = 15;
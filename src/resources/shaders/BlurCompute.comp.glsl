@@ -0,0 +1,50 @@
+#version 430 core
+
+// separable Gaussian blur pass: a work group convolves a segment of a row (column)
+// of TileSize texels, which are loaded to the shared memory once with the kernel apron.
+// The image is resampled to the output size while loading, see GaussianBlur
+
+const int TileSize = 128; // ComputeTileSize of GaussianBlur
+const int MaxRadius = 32; // GaussianBlur::MaxRadius
+
+layout (local_size_x = TileSize) in;
+
+uniform sampler2D image;
+uniform vec2 direction; // (1, 0) or (0, 1)
+uniform int radius;
+uniform float weights[MaxRadius + 1]; // from the center
+
+layout (binding = 0, rgba16f) writeonly uniform image2D outImage;
+
+shared vec4 tile[TileSize + 2 * MaxRadius];
+
+void main() {
+    ivec2 size = imageSize(outImage);
+    ivec2 axis = ivec2(direction);
+    ivec2 across = ivec2(1) - axis;
+
+    int lineLength = axis.x == 1 ? size.x : size.y;
+    int line = int(gl_WorkGroupID.y);
+    int start = int(gl_WorkGroupID.x) * TileSize;
+    int local = int(gl_LocalInvocationID.x);
+
+    for (int i = local; i < TileSize + 2 * radius; i += TileSize) {
+        int along = clamp(start + i - radius, 0, lineLength - 1);
+        vec2 texel = vec2(axis * along + across * line) + 0.5;
+        tile[i] = textureLod(image, texel / vec2(size), 0.0);
+    }
+
+    barrier();
+
+    int along = start + local;
+
+    if (along >= lineLength)
+        return;
+
+    vec4 color = tile[local + radius] * weights[0];
+
+    for (int i = 1; i <= radius; i++)
+        color += (tile[local + radius - i] + tile[local + radius + i]) * weights[i];
+
+    imageStore(outImage, axis * along + across * line, color);
+}
@@ -0,0 +1,36 @@
+// dual Kawase blur: downsample by 4 diagonal fetches around the center,
+// upsample by 8 fetches around it (Bjorge, "Bandwidth-Efficient Rendering"), see GaussianBlur
+
+uniform sampler2D image;
+uniform vec2 halfPixel; // of the target
+uniform bool upsample;
+
+layout (location = 0) out vec4 fragColor;
+
+in vec2 texCoord;
+
+void main() {
+    vec2 uv = texCoord;
+    vec2 o = halfPixel;
+
+    if (!upsample) {
+        vec4 sum = texture(image, uv) * 4.0;
+        sum += texture(image, uv - o);
+        sum += texture(image, uv + o);
+        sum += texture(image, uv + vec2(o.x, -o.y));
+        sum += texture(image, uv - vec2(o.x, -o.y));
+
+        fragColor = sum / 8.0;
+    } else {
+        vec4 sum = texture(image, uv + vec2(-o.x * 2.0, 0.0));
+        sum += texture(image, uv + vec2(-o.x, o.y)) * 2.0;
+        sum += texture(image, uv + vec2(0.0, o.y * 2.0));
+        sum += texture(image, uv + vec2(o.x, o.y)) * 2.0;
+        sum += texture(image, uv + vec2(o.x * 2.0, 0.0));
+        sum += texture(image, uv + vec2(o.x, -o.y)) * 2.0;
+        sum += texture(image, uv + vec2(0.0, -o.y * 2.0));
+        sum += texture(image, uv + vec2(-o.x, -o.y)) * 2.0;
+
+        fragColor = sum / 12.0;
+    }
+}
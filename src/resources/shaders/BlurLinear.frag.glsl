@@ -0,0 +1,26 @@
+// separable Gaussian blur pass with the adjacent taps merged into bilinear
+// fetches between them, see GaussianBlur
+
+const int MaxTaps = 17; // GaussianBlur::MaxRadius / 2 + 1
+
+uniform sampler2D image;
+uniform vec2 direction; // (1, 0) or (0, 1)
+uniform int tapsCount;
+uniform float offsets[MaxTaps]; // in texels, offsets[0] = 0
+uniform float weights[MaxTaps];
+
+layout (location = 0) out vec4 fragColor;
+
+in vec2 texCoord;
+
+void main() {
+    vec2 texelStep = direction / vec2(textureSize(image, 0));
+    vec4 color = texture(image, texCoord) * weights[0];
+
+    for (int i = 1; i < tapsCount; i++) {
+        vec2 offset = texelStep * offsets[i];
+        color += (texture(image, texCoord + offset) + texture(image, texCoord - offset)) * weights[i];
+    }
+
+    fragColor = color;
+}
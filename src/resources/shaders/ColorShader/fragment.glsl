@@ -12,7 +12,7 @@ uniform float diffuseStrength;
 uniform float specularStrength;
 uniform float shininess;
 
-uniform mat4 viewMatrix;
+#alp include "Frame.glsl"
 
 in mat3 matTBN;
 in vec3 worldPosition; // fragment pos in world space
@@ -21,9 +21,18 @@ in vec2 texCoord;
 
 // output colors
 layout(location = 0) out vec4 fragColor;
+
+#ifdef COMPACT_GBUFFER
+#alp include "GBuffer.glsl"
+
+// position is reconstructed from depth
+layout(location = 1) out vec2 normalBuffer;
+layout(location = 2) out vec2 ssrValuesBuffer;
+#else
 layout(location = 1) out vec3 normalBuffer;
 layout(location = 2) out vec3 positionBuffer;
 layout(location = 3) out vec2 ssrValuesBuffer;
+#endif
 
 #alp include <NormalMapping.fs>
 #alp include <Shading/diffuseLambert>
@@ -47,7 +56,7 @@ vec3 diffuseResult = vec3(0.0f);
 vec3 specularResult = vec3(0.0f);
 
 LightingResult calculateBaseLighting(vec3 pos, vec3 color, float kc, float kl, float kq) {
-    vec3 lampEyePos = vec3(viewMatrix * vec4(pos, 1.0));
+    vec3 lampEyePos = vec3(frame.view * vec4(pos, 1.0));
 
     LightingResult lighting;
     lighting.lightDir = normalize(lampEyePos - viewPosition);
@@ -120,8 +129,12 @@ void main() {
 			vec4(diffuseResult, 1.0f) * texture(diffuse, texCoord) +
 			vec4(specularResult, 1.0f) * texture(specular, texCoord);
 
+#ifdef COMPACT_GBUFFER
+	normalBuffer = encodeNormal(viewNormal);
+#else
 	normalBuffer = viewNormal;
 	positionBuffer = viewPosition;
+#endif
 	ssrValuesBuffer.r = texture(reflectionStrength, texCoord).r;
 	ssrValuesBuffer.g = texture(jitter, texCoord).r;
 }
@@ -2,14 +2,17 @@
 
 #alp include <NormalMapping.vs>
 #alp include <BoneSystem>
+#alp include "Frame.glsl"
 
-uniform mat4 MVPMatrix, modelMatrix, viewMatrix, MVMatrix;
+uniform mat4 modelMatrix;
+uniform bool preSkinned; // vertices are already skinned, see PreSkinning
 
 in vec4 inPos;
 in vec3 inNormal;
 in vec3 inTangent;
 in vec3 inBitangent;
 in vec2 inTexCoord;
+layout(location = 12) in mat4 inInstanceMatrix; // identity for non-instanced models, see InstancedModelGroup
 
 out mat3 matTBN;
 out vec3 worldPosition;
@@ -20,18 +23,21 @@ void main() {
     vec4 position = inPos;
     vec3 normal = inNormal;
 
-    if (isBonesPresent()) {
+    if (isBonesPresent() && !preSkinned) {
         mat4 finalTransform = getBoneTransformMatrix();
         position = finalTransform * position;
         normal = mat3(finalTransform) * normal;
     }
 
+    mat4 modelInstanceMatrix = modelMatrix * inInstanceMatrix;
+    vec4 world = modelInstanceMatrix * position;
+
     // gl_Position is a special variable used to store the final position.
     // Multiply the vertex by the matrix to get the final point in normalized screen coordinates.
-    gl_Position = MVPMatrix * position;
+    gl_Position = frame.viewProjection * world;
 
-    worldPosition = vec3(modelMatrix * position);
-    viewPosition = vec3(viewMatrix * vec4(worldPosition, 1.0));
+    worldPosition = vec3(world);
+    viewPosition = vec3(frame.view * world);
     texCoord = inTexCoord;
-    matTBN = getTBNMatrix(MVMatrix, inTangent, inBitangent, normal);
+    matTBN = getTBNMatrix(frame.view * modelInstanceMatrix, inTangent, inBitangent, normal);
 }
@@ -4,15 +4,28 @@ layout (location = 0) out float fragCoC;
 
 #alp include <DOF/cinematicCoC>
 
+#ifdef COMPACT_GBUFFER
+#alp include "Frame.glsl"
+#alp include "GBuffer.glsl"
+
+uniform sampler2D depthMap;
+#else
 uniform sampler2D positionMap;
+#endif
 
 uniform float planeInFocus;
 uniform float aperture;
 uniform float imageDistance;
 
 void main() {
+#ifdef COMPACT_GBUFFER
+    float depth = getViewPosition(depthMap, texCoord).z;
+#else
+    float depth = texture(positionMap, texCoord).z;
+#endif
+
     float sigma = cinematicCoC(
-        texture(positionMap, texCoord).z,
+        depth,
         planeInFocus,
         aperture,
         imageDistance
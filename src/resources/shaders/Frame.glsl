@@ -0,0 +1,12 @@
+// per-frame camera and scene values, see FrameUniforms
+layout(std140) uniform Frame {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    mat4 invView;
+    mat4 invProjection;
+    mat4 invViewProjection;
+    vec4 cameraPos; // w is unused
+    vec4 viewport; // width, height, 1 / width, 1 / height
+    float time;
+} frame;
@@ -0,0 +1,33 @@
+// compact G-buffer: octahedral normals (RG16) and view space positions
+// reconstructed from the depth buffer. Requires Frame.glsl
+
+vec2 octahedronWrap(vec2 v) {
+    return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+// [0, 1], for unsigned normalized formats
+vec2 encodeNormal(vec3 n) {
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    n.xy = n.z >= 0.0 ? n.xy : octahedronWrap(n.xy);
+    return n.xy * 0.5 + 0.5;
+}
+
+vec3 decodeNormal(vec2 e) {
+    e = e * 2.0 - 1.0;
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+// zero for the cleared depth (sky), as in the position map
+vec3 getViewPosition(sampler2D depthMap, vec2 uv) {
+    float depth = texture(depthMap, uv).r;
+
+    if (depth >= 1.0)
+        return vec3(0.0);
+
+    vec4 pos = frame.invProjection * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+
+    return pos.xyz / pos.w;
+}
@@ -0,0 +1,32 @@
+// Hi-Z pyramid level: copy of the depth buffer for level 0,
+// min depth of the previous level (bound as the only one) otherwise
+
+uniform sampler2D srcMap;
+uniform bool downsample;
+
+layout (location = 0) out float fragDepth;
+
+void main() {
+    ivec2 dst = ivec2(gl_FragCoord.xy);
+
+    if (!downsample) {
+        fragDepth = texelFetch(srcMap, dst, 0).r;
+        return;
+    }
+
+    ivec2 srcMax = textureSize(srcMap, 0) - 1;
+    ivec2 src = dst * 2;
+
+    // odd source size: the last texels of the level also cover its extra row / column
+    ivec2 count = ivec2(src.x + 2 == srcMax.x ? 3 : 2, src.y + 2 == srcMax.y ? 3 : 2);
+
+    float depth = 1.0;
+
+    for (int y = 0; y < count.y; y++) {
+        for (int x = 0; x < count.x; x++) {
+            depth = min(depth, texelFetch(srcMap, min(src + ivec2(x, y), srcMax), 0).r);
+        }
+    }
+
+    fragDepth = depth;
+}
@@ -0,0 +1,11 @@
+#version 410 core
+
+in vec3 worldPosition;
+
+uniform vec3 lightPos;
+uniform float farPlane;
+
+void main() {
+    // linear distance to the light, the same as in the geometry shader path
+    gl_FragDepth = length(worldPosition - lightPos) / farPlane;
+}
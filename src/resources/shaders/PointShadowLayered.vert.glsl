@@ -0,0 +1,44 @@
+#version 410 core
+
+// POINT_SHADOW_INSTANCED: all faces in one draw, face = instance id % 6, written to gl_Layer
+// POINT_SHADOW_PER_FACE: one draw per face, face is set by uniform
+
+#ifdef POINT_SHADOW_INSTANCED
+#extension GL_ARB_shader_viewport_layer_array : enable
+#extension GL_AMD_vertex_shader_layer : enable
+#endif
+
+#alp include <BoneSystem>
+
+uniform mat4 transformationMatrix; // model matrix
+uniform mat4 shadowMatrices[6];
+uniform bool preSkinned; // vertices are already skinned, see PreSkinning
+
+#ifdef POINT_SHADOW_PER_FACE
+uniform int face;
+#endif
+
+in vec4 a_Position;
+layout(location = 12) in mat4 inInstanceMatrix; // identity for non-instanced models, see InstancedModelGroup
+
+out vec3 worldPosition;
+
+void main() {
+    vec4 position = a_Position;
+
+    if (isBonesPresent() && !preSkinned)
+        position = getBoneTransformMatrix() * position;
+
+    vec4 world = transformationMatrix * inInstanceMatrix * position;
+    worldPosition = world.xyz;
+
+#ifdef POINT_SHADOW_INSTANCED
+    // instance matrix divisor is 6 for the instanced groups
+    int face = gl_InstanceID % 6;
+
+    gl_Layer = face;
+    gl_Position = shadowMatrices[face] * world;
+#else
+    gl_Position = shadowMatrices[face] * world;
+#endif
+}
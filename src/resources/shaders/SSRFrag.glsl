@@ -1,24 +1,57 @@
-#alp include <SSR>
+#alp include "Frame.glsl"
 
 uniform sampler2D baseImage;
 uniform sampler2D normalMap; // in view space
 uniform sampler2D ssrValuesMap;
+uniform float minReflectionStrength;
+
+#ifdef COMPACT_GBUFFER
+uniform sampler2D depthMap;
+
+#alp include "GBuffer.glsl"
+#alp include "SSRTrace.glsl"
+#else
+#alp include <SSR>
+
 uniform sampler2D positionMap; // in view space
-uniform mat4 projection;
-uniform mat4 view;
+#endif
 
 layout (location = 0) out vec3 fragColor;
 
 in vec2 texCoord;
 
 void main() {
+    vec2 ssrValues = texture(ssrValuesMap, texCoord).rg;
+
+    // most pixels don't reflect: exit before the trace
+    if (ssrValues.r < minReflectionStrength) {
+        fragColor = texture(baseImage, texCoord).rgb;
+        return;
+    }
+
+#ifdef COMPACT_GBUFFER
+    SSRTraceValues values;
+    values.uv = texCoord;
+    values.reflectionStrength = ssrValues.r;
+    values.jitter = ssrValues.g;
+    values.rayMarchCount = 30;
+    values.binarySearchCount = 10;
+    values.rayStep = 0.05f;
+    values.minRayStep = 0.2f;
+    values.thickness = 1.2f;
+
+    vec3 viewPos = getViewPosition(depthMap, texCoord);
+    vec3 viewNormal = decodeNormal(texture(normalMap, texCoord).rg);
+
+    fragColor = ssrTrace(baseImage, viewPos, viewNormal, values);
+#else
     SSRValues values;
     values.fallbackColor = vec3(0.0);
     values.uv = texCoord;
-    values.projection = projection;
-    values.view = view;
-    values.reflectionStrength = texture(ssrValuesMap, texCoord).r;
-    values.jitter = texture(ssrValuesMap, texCoord).g;
+    values.projection = frame.projection;
+    values.view = frame.view;
+    values.reflectionStrength = ssrValues.r;
+    values.jitter = ssrValues.g;
     values.rayMarchCount = 30;
     values.binarySearchCount = 10;
     values.rayStep = 0.05f;
@@ -26,4 +59,5 @@ void main() {
     values.minRayStep = 0.2f;
 
     fragColor = ssrGetColor(baseImage, normalMap, positionMap, values);
+#endif
 }
@@ -0,0 +1,52 @@
+// traces the reflections at 1 / traceScale of the resolution,
+// the hits are resolved by SSRResolve.frag.glsl at the full one
+
+#alp include "Frame.glsl"
+#alp include "GBuffer.glsl"
+
+uniform sampler2D normalMap; // in view space, octahedral in the compact mode
+uniform sampler2D ssrValuesMap;
+uniform sampler2D depthMap;
+uniform sampler2D hiZMap;
+uniform int hiZLevels;
+uniform int traceScale;
+uniform float minReflectionStrength;
+
+#alp include "SSRHiZTrace.glsl"
+
+layout (location = 0) out vec4 fragHit; // uv, weight
+
+void main() {
+    // the top left pixel of the block is traced, resolve compares depths with it
+    ivec2 pixel = ivec2(gl_FragCoord.xy) * traceScale;
+    vec2 ssrValues = texelFetch(ssrValuesMap, pixel, 0).rg;
+
+    fragHit = vec4(0.0);
+
+    // most pixels don't reflect: exit before the other fetches
+    if (ssrValues.r < minReflectionStrength)
+        return;
+
+    vec2 uv = (vec2(pixel) + 0.5) / vec2(textureSize(depthMap, 0));
+    vec3 viewPos = getViewPosition(depthMap, uv);
+
+    if (viewPos.z == 0.0)
+        return;
+
+#ifdef COMPACT_GBUFFER
+    vec3 viewNormal = decodeNormal(texelFetch(normalMap, pixel, 0).rg);
+#else
+    vec3 viewNormal = normalize(texelFetch(normalMap, pixel, 0).xyz);
+#endif
+
+    SSRHiZValues values;
+    values.uv = uv;
+    values.reflectionStrength = ssrValues.r;
+    values.jitter = ssrValues.g;
+    values.maxIterations = 64;
+    values.maxDistance = 32.0f;
+    values.minRayStep = 0.2f;
+    values.thickness = 1.2f;
+
+    fragHit = vec4(ssrHiZTrace(viewPos, viewNormal, values), 1.0);
+}
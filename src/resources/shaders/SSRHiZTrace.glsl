@@ -0,0 +1,104 @@
+// Screen space reflections over the Hi-Z pyramid (HiZPyramid). The ray is marched in screen space,
+// where uv and depth of the projected ray change linearly: it skips the cells it's in front of,
+// going to the coarser level each time when it leaves a cell, and to the finer one
+// when it reaches the min depth of the cell.
+// Requires Frame.glsl, hiZMap and hiZLevels declared before the include
+
+struct SSRHiZValues {
+    vec2 uv;
+    float reflectionStrength;
+    float jitter;
+    int maxIterations;
+    float maxDistance; // in view space
+    float minRayStep;
+    float thickness;
+};
+
+vec3 ssrHiZProject(vec3 viewPos) {
+    vec4 pos = frame.projection * vec4(viewPos, 1.0);
+    return pos.xyz / pos.w * 0.5 + 0.5;
+}
+
+float ssrHiZViewZ(float depth) {
+    return -frame.projection[3][2] / (depth * 2.0 - 1.0 + frame.projection[2][2]);
+}
+
+// ray parameter, at which it leaves the cell
+float ssrHiZCellExit(vec3 start, vec3 dir, vec2 cell, vec2 cellCount, vec2 crossStep, vec2 crossOffset) {
+    vec2 boundary = (cell + crossStep) / cellCount + crossOffset;
+    vec2 t = (boundary - start.xy) / dir.xy;
+    return min(t.x, t.y);
+}
+
+// hit uv in xy and its weight (reflection strength with the fade) in z, zero if missed
+vec3 ssrHiZTrace(vec3 viewPos, vec3 viewNormal, SSRHiZValues values) {
+    vec3 reflected = normalize(reflect(normalize(viewPos), viewNormal));
+
+    // the same jitter as SSRTrace: relative to the step, which is proportional to the distance
+    float noise = fract(sin(dot(values.uv, vec2(12.9898, 78.233))) * 43758.5453) - 0.5;
+    reflected = normalize(vec3(noise * values.jitter) + reflected * max(values.minRayStep, -viewPos.z));
+
+    // the ray is clipped by the near plane
+    float near = frame.projection[3][2] / (frame.projection[2][2] - 1.0);
+    float rayLength = values.maxDistance;
+
+    if (reflected.z > 0.0)
+        rayLength = min(rayLength, (-near - viewPos.z) / reflected.z * 0.99);
+
+    vec3 start = ssrHiZProject(viewPos);
+    vec3 dir = ssrHiZProject(viewPos + reflected * rayLength) - start;
+
+    // towards or away from the camera, screen space reflection is not possible
+    if (dot(dir.xy, dir.xy) < 1e-10)
+        return vec3(0.0);
+
+    vec2 crossStep = vec2(dir.x >= 0.0 ? 1.0 : 0.0, dir.y >= 0.0 ? 1.0 : 0.0);
+    vec2 crossOffset = (crossStep * 2.0 - 1.0) / vec2(textureSize(hiZMap, 0)) * 0.01;
+
+    // starts from the next texel, so the surface doesn't hit itself
+    vec2 baseCount = vec2(textureSize(hiZMap, 0));
+    float t = ssrHiZCellExit(start, dir, floor(start.xy * baseCount), baseCount, crossStep, crossOffset);
+    int level = 0;
+
+    for (int i = 0; i < values.maxIterations; i++) {
+        vec3 ray = start + dir * t;
+
+        if (t > 1.0 || any(lessThan(ray.xy, vec2(0.0))) || any(greaterThan(ray.xy, vec2(1.0))))
+            break;
+
+        ivec2 levelSize = textureSize(hiZMap, level);
+        vec2 cellCount = vec2(levelSize);
+        vec2 cell = floor(ray.xy * cellCount);
+        float minZ = texelFetch(hiZMap, min(ivec2(cell), levelSize - 1), level).r;
+        float tCell = ssrHiZCellExit(start, dir, cell, cellCount, crossStep, crossOffset);
+
+        // parameter of the min depth, if the ray goes away from the camera;
+        // otherwise the depth of the ray decreases, so being in front of the cell
+        // it stays in front until the cell exit
+        float tDepth = dir.z > 0.0 ? (minZ - start.z) / dir.z : tCell;
+        bool inFront = dir.z > 0.0 ? tDepth > t : ray.z < minZ;
+
+        if (inFront) {
+            if (tDepth < tCell) {
+                // reaches the nearest surface inside the cell
+                t = tDepth;
+                level = max(level - 1, 0);
+            } else {
+                t = tCell;
+                level = min(level + 1, hiZLevels - 1);
+            }
+        } else if (level > 0) {
+            level--;
+        } else if (ssrHiZViewZ(minZ) - ssrHiZViewZ(ray.z) < values.thickness) {
+            vec2 edge = smoothstep(0.2, 0.6, abs(vec2(0.5) - ray.xy));
+            float fade = clamp(1.0 - (edge.x + edge.y), 0.0, 1.0) * (1.0 - smoothstep(0.75, 1.0, t));
+
+            return vec3(ray.xy, values.reflectionStrength * fade);
+        } else {
+            // behind a thin surface, continues after it
+            t = tCell;
+        }
+    }
+
+    return vec3(0.0);
+}
@@ -0,0 +1,69 @@
+// applies the hits of SSRHiZ.frag.glsl at the full resolution. Half resolution hits are
+// upsampled bilaterally: bilinear weights of the 4 nearest traced pixels are attenuated
+// by their depth difference, so reflections don't leak over the edges
+
+#alp include "Frame.glsl"
+#alp include "GBuffer.glsl"
+
+uniform sampler2D baseImage;
+uniform sampler2D depthMap;
+uniform sampler2D hitMap; // uv, weight
+uniform int traceScale;
+
+layout (location = 0) out vec3 fragColor;
+
+in vec2 texCoord;
+
+vec3 getReflection(vec3 hit) {
+    return hit.z > 0.0 ? texture(baseImage, hit.xy).rgb * hit.z : vec3(0.0);
+}
+
+void main() {
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    vec3 color = texelFetch(baseImage, pixel, 0).rgb;
+
+    if (traceScale == 1) {
+        vec3 hit = texelFetch(hitMap, pixel, 0).xyz;
+        fragColor = color * (1.0 - hit.z) + getReflection(hit);
+        return;
+    }
+
+    float depth = getViewPosition(depthMap, texCoord).z;
+
+    if (depth == 0.0) {
+        fragColor = color;
+        return;
+    }
+
+    vec2 depthTexel = 1.0 / vec2(textureSize(depthMap, 0));
+    ivec2 hitMax = textureSize(hitMap, 0) - 1;
+
+    vec2 pos = (vec2(pixel) + 0.5) / float(traceScale) - 0.5;
+    ivec2 base = ivec2(floor(pos));
+    vec2 f = fract(pos);
+
+    vec3 reflection = vec3(0.0);
+    float strength = 0.0;
+    float weights = 0.0;
+
+    for (int i = 0; i < 4; i++) {
+        ivec2 offset = ivec2(i & 1, i >> 1);
+        ivec2 texel = clamp(base + offset, ivec2(0), hitMax);
+
+        float sampleDepth = getViewPosition(depthMap, (vec2(texel * traceScale) + 0.5) * depthTexel).z;
+        vec2 bilinear = mix(1.0 - f, f, vec2(offset));
+        float weight = bilinear.x * bilinear.y * exp(-abs(depth - sampleDepth) / (0.05 * -depth));
+
+        vec3 hit = texelFetch(hitMap, texel, 0).xyz;
+
+        reflection += getReflection(hit) * weight;
+        strength += hit.z * weight;
+        weights += weight;
+    }
+
+    if (weights > 1e-4) {
+        fragColor = color * (1.0 - strength / weights) + reflection / weights;
+    } else {
+        fragColor = color;
+    }
+}
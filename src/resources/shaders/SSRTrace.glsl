@@ -0,0 +1,75 @@
+// Screen space reflections over the depth buffer: linear ray march followed by
+// binary search, with the same params as SSRValues of <SSR>, which reads the position map.
+// Requires Frame.glsl, GBuffer.glsl and depthMap declared before the include
+
+struct SSRTraceValues {
+    vec2 uv;
+    float reflectionStrength;
+    float jitter;
+    int rayMarchCount;
+    int binarySearchCount;
+    float rayStep;
+    float minRayStep;
+    float thickness;
+};
+
+vec2 ssrProject(vec3 viewPos) {
+    vec4 pos = frame.projection * vec4(viewPos, 1.0);
+    return pos.xy / pos.w * 0.5 + 0.5;
+}
+
+bool ssrIsOnScreen(vec2 uv) {
+    return all(greaterThanEqual(uv, vec2(0.0))) && all(lessThanEqual(uv, vec2(1.0)));
+}
+
+vec2 ssrBinarySearch(vec3 dir, vec3 hit, int count) {
+    for (int i = 0; i < count; i++) {
+        float sceneZ = getViewPosition(depthMap, ssrProject(hit)).z;
+
+        // view space z is negative: positive difference - the ray is still in front of the surface
+        dir *= 0.5;
+        hit += hit.z - sceneZ > 0.0 ? dir : -dir;
+    }
+
+    return ssrProject(hit);
+}
+
+vec3 ssrTrace(sampler2D baseImage, vec3 viewPos, vec3 viewNormal, SSRTraceValues values) {
+    vec3 color = texture(baseImage, values.uv).rgb;
+
+    if (values.reflectionStrength <= 0.0 || viewPos.z == 0.0)
+        return color;
+
+    vec3 reflected = normalize(reflect(normalize(viewPos), viewNormal));
+
+    float noise = fract(sin(dot(values.uv, vec2(12.9898, 78.233))) * 43758.5453) - 0.5;
+    vec3 dir = (vec3(noise * values.jitter) + reflected * max(values.minRayStep, -viewPos.z)) * values.rayStep;
+    vec3 hit = viewPos;
+
+    for (int i = 0; i < values.rayMarchCount; i++) {
+        hit += dir;
+
+        vec2 uv = ssrProject(hit);
+
+        if (!ssrIsOnScreen(uv))
+            break;
+
+        float sceneZ = getViewPosition(depthMap, uv).z;
+
+        if (sceneZ == 0.0)
+            continue;
+
+        float dDepth = hit.z - sceneZ;
+
+        if (dDepth <= 0.0 && dir.z - dDepth < values.thickness) {
+            vec2 hitUV = ssrBinarySearch(dir, hit, values.binarySearchCount);
+
+            vec2 edge = smoothstep(0.2, 0.6, abs(vec2(0.5) - hitUV));
+            float fade = clamp(1.0 - (edge.x + edge.y), 0.0, 1.0);
+
+            return mix(color, texture(baseImage, hitUV).rgb, values.reflectionStrength * fade);
+        }
+    }
+
+    return color;
+}
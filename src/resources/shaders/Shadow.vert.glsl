@@ -0,0 +1,20 @@
+#version 330 core
+
+#alp include <BoneSystem>
+
+// dir light shadows: light space matrix * model matrix
+// point light shadows: model matrix, faces are emitted by the geometry shader
+uniform mat4 transformationMatrix;
+uniform bool preSkinned; // vertices are already skinned, see PreSkinning
+
+in vec4 a_Position;
+layout(location = 12) in mat4 inInstanceMatrix; // identity for non-instanced models, see InstancedModelGroup
+
+void main() {
+    vec4 position = a_Position;
+
+    if (isBonesPresent() && !preSkinned)
+        position = getBoneTransformMatrix() * position;
+
+    gl_Position = transformationMatrix * inInstanceMatrix * position;
+}
@@ -0,0 +1,26 @@
+#version 330 core
+
+// pre-skinning: vertices of the skinned shapes are transformed once per frame
+// and captured by transform feedback, see PreSkinning
+
+#alp include <BoneSystem>
+
+in vec4 inPos;
+in vec3 inNormal;
+in vec3 inTangent;
+in vec3 inBitangent;
+
+out vec3 skinnedPos;
+out vec3 skinnedNormal;
+out vec3 skinnedTangent;
+out vec3 skinnedBitangent;
+
+void main() {
+    mat4 transform = getBoneTransformMatrix();
+    mat3 transform3 = mat3(transform);
+
+    skinnedPos = vec3(transform * inPos);
+    skinnedNormal = transform3 * inNormal;
+    skinnedTangent = transform3 * inTangent;
+    skinnedBitangent = transform3 * inBitangent;
+}